@@ -0,0 +1,116 @@
+#ifndef ARG_TOKEN_H
+#define ARG_TOKEN_H
+#include <cstddef>
+#include <cstdint>
+
+// The classification pass reads whole aligned 16 byte blocks, which can reach
+// past the end of an argument but never into another page, the same way the
+// C library's strlen does. The sanitizers cannot tell that apart from a real
+// overflow, so the scalar loop is used under them, and wherever SSE2 is not
+// available. Define CPP_CLI_NO_SIMD to always use it.
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer)
+#define CPP_CLI_SANITIZED
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define CPP_CLI_SANITIZED
+#endif
+
+#if defined(__SSE2__) && defined(__GNUC__) && !defined(CPP_CLI_NO_SIMD) && !defined(CPP_CLI_SANITIZED)
+#define CPP_CLI_SSE2_TOKENS
+#include <emmintrin.h>
+#endif
+
+namespace cli {
+
+enum class Arg_Kind : uint8_t {
+	non_option,
+	// "-"
+	dash,
+	// "--"
+	dash_dash,
+	// "-x..."
+	short_option,
+	// "--x..."
+	long_option
+};
+
+// What the parser needs to know about an argument before looking anything up,
+// found in a single pass over its characters.
+struct Arg_Token {
+	size_t length;
+	// Where the first '=' is, or length if there is none.
+	size_t split;
+	Arg_Kind kind;
+};
+
+inline Arg_Kind arg_kind(const char * arg, size_t length) {
+	if (arg[0] != '-') {
+		return Arg_Kind::non_option;
+	}
+	if (length == 1) {
+		return Arg_Kind::dash;
+	}
+	if (arg[1] != '-') {
+		return Arg_Kind::short_option;
+	}
+	return length == 2 ? Arg_Kind::dash_dash : Arg_Kind::long_option;
+}
+
+inline Arg_Token classify_argument_scalar(const char * arg) {
+	size_t split = (size_t)-1;
+	size_t length = 0;
+	for (; arg[length] != '\0'; length++) {
+		if (arg[length] == '=' && split == (size_t)-1) {
+			split = length;
+		}
+	}
+	return { length, split < length ? split : length, arg_kind(arg, length) };
+}
+
+#ifdef CPP_CLI_SSE2_TOKENS
+// Finds the terminator and the first '=' 16 bytes at a time. The first block
+// is aligned down, so the bits of the bytes in front of the argument are
+// masked off.
+inline Arg_Token classify_argument_sse2(const char * arg) {
+	const __m128i terminator = _mm_setzero_si128();
+	const __m128i equals = _mm_set1_epi8('=');
+	const char * block = arg - ((uintptr_t)arg & 15);
+	unsigned int skip = (unsigned int)(arg - block);
+	size_t split = (size_t)-1;
+	for (;;) {
+		__m128i bytes = _mm_load_si128((const __m128i *)block);
+		unsigned int ends = ((unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, terminator)) >> skip) << skip;
+		unsigned int splits = ((unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, equals)) >> skip) << skip;
+		if (splits != 0 && split == (size_t)-1) {
+			split = (size_t)(block + __builtin_ctz(splits) - arg);
+		}
+		if (ends != 0) {
+			size_t length = (size_t)(block + __builtin_ctz(ends) - arg);
+			return { length, split < length ? split : length, arg_kind(arg, length) };
+		}
+		block += 16;
+		skip = 0;
+	}
+}
+#endif
+
+inline Arg_Token classify_argument(const char * arg) {
+#ifdef CPP_CLI_SSE2_TOKENS
+	return classify_argument_sse2(arg);
+#else
+	return classify_argument_scalar(arg);
+#endif
+}
+
+// Fills tokens[i] for every argv[i], which is done once before anything is
+// looked up, so that no argument has to be scanned again while it is handled.
+inline void classify_arguments(int argc, const char * const * argv, Arg_Token * tokens) {
+	for (int i = 0; i < argc; i++) {
+		tokens[i] = classify_argument(argv[i]);
+	}
+}
+
+}
+#endif
@@ -0,0 +1,159 @@
+#ifndef ARG_VIEW_H
+#define ARG_VIEW_H
+#include "cli_containers.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cli {
+
+// A non-owning (pointer, length) view into a command line argument or an
+// alias. Nothing is copied, so the characters must outlive the view, which is
+// already the case for argv and for string literals used as aliases.
+struct Arg_View {
+	const char * data;
+	size_t length;
+
+	Arg_View() : data(""), length(0) {}
+	Arg_View(const char * d, size_t l) : data(d), length(l) {}
+	Arg_View(const char * d) : data(d), length(strlen(d)) {}
+
+	bool empty() const;
+	bool starts_with(const char * prefix, size_t prefix_length) const;
+	Arg_View substr(size_t start) const;
+	std::string str() const;
+};
+
+inline bool operator==(const Arg_View& a, const Arg_View& b) {
+	return a.length == b.length && memcmp(a.data, b.data, a.length) == 0;
+}
+
+inline bool operator!=(const Arg_View& a, const Arg_View& b) {
+	return !(a == b);
+}
+
+// Orders by length first so that most comparisons are decided without
+// touching the characters at all.
+inline bool operator<(const Arg_View& a, const Arg_View& b) {
+	if (a.length != b.length) {
+		return a.length < b.length;
+	}
+	return memcmp(a.data, b.data, a.length) < 0;
+}
+
+// FNV-1a over the characters, so that views can key a hash map without a
+// string being built for every lookup.
+struct Arg_View_Hash {
+	size_t operator()(const Arg_View& view) const {
+		uint64_t hash = 14695981039346656037ULL;
+		for (size_t i = 0; i < view.length; i++) {
+			hash = (hash ^ (unsigned char)view.data[i]) * 1099511628211ULL;
+		}
+		return (size_t)hash;
+	}
+};
+
+inline bool Arg_View::empty() const {
+	return length == 0;
+}
+
+inline bool Arg_View::starts_with(const char * prefix, size_t prefix_length) const {
+	return length >= prefix_length && memcmp(data, prefix, prefix_length) == 0;
+}
+
+inline Arg_View Arg_View::substr(size_t start) const {
+	return Arg_View(data + start, length - start);
+}
+
+inline std::string Arg_View::str() const {
+	return std::string(data, length);
+}
+
+// A compact, sorted table of views. Entries are appended in any order and the
+// table is sorted the first time it is searched, so a lookup is a single
+// binary search with no hashing and no string copies.
+template <typename V>
+class View_Table {
+private:
+	cli_vector<std::pair<Arg_View, V>> entries;
+	bool sorted = true;
+private:
+	static bool entry_less(const std::pair<Arg_View, V>& a, const std::pair<Arg_View, V>& b);
+	static bool entry_key_less(const std::pair<Arg_View, V>& a, const Arg_View& key);
+	void sort_entries();
+public:
+	View_Table() {}
+#ifdef CPP_CLI_PMR
+	explicit View_Table(cli_memory_resource * resource) : entries(resource) {}
+#endif
+	void reserve(size_t n);
+	void insert(Arg_View key, V value);
+	size_t size() const;
+	const std::pair<Arg_View, V>& operator[](size_t i) const;
+	const V * find(Arg_View key);
+};
+
+template <typename V>
+inline bool View_Table<V>::entry_less(const std::pair<Arg_View, V>& a, const std::pair<Arg_View, V>& b) {
+	return a.first < b.first;
+}
+
+template <typename V>
+inline bool View_Table<V>::entry_key_less(const std::pair<Arg_View, V>& a, const Arg_View& key) {
+	return a.first < key;
+}
+
+template <typename V>
+inline void View_Table<V>::sort_entries() {
+	std::stable_sort(entries.begin(), entries.end(), entry_less);
+	for (size_t i = 1; i < entries.size(); i++) {
+		if (entries[i - 1].first == entries[i].first) {
+			std::string error_message;
+			error_message.reserve(64);
+			error_message += "Flag already used: ";
+			error_message += entries[i].first.str();
+			raise_error<std::invalid_argument>(error_message);
+		}
+	}
+	sorted = true;
+}
+
+template <typename V>
+inline void View_Table<V>::reserve(size_t n) {
+	entries.reserve(n);
+}
+
+template <typename V>
+inline void View_Table<V>::insert(Arg_View key, V value) {
+	sorted = sorted && (entries.empty() || entries.back().first < key);
+	entries.push_back({key, value});
+}
+
+template <typename V>
+inline size_t View_Table<V>::size() const {
+	return entries.size();
+}
+
+template <typename V>
+inline const std::pair<Arg_View, V>& View_Table<V>::operator[](size_t i) const {
+	return entries[i];
+}
+
+template <typename V>
+inline const V * View_Table<V>::find(Arg_View key) {
+	if (!sorted) {
+		sort_entries();
+	}
+	typename cli_vector<std::pair<Arg_View, V>>::const_iterator it = std::lower_bound(entries.begin(), entries.end(), key, entry_key_less);
+	if (it == entries.end() || it->first != key) {
+		return nullptr;
+	}
+	return &it->second;
+}
+
+}
+#endif
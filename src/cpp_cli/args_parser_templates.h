@@ -1,15 +1,28 @@
 #ifndef CPP_CMD_LINE_PARSER_TEMPLATES_H
 #define CPP_CMD_LINE_PARSER_TEMPLATES_H
+#include "arg_view.h"
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace cli{
+
+class Argv_Writer;
+class Parser;
 	
 class CLI_Interface {
+friend class Parser;
 protected:
 	bool takes_args_var;
 	void * base_variable;
 	std::vector<const char *> aliases;
 	const char * help_message;
+	// The parser the option was added to and its position there, which is
+	// where whether and where it was seen is recorded.
+	Parser * owner = nullptr;
+	uint32_t option_index = 0;
 public:
 	CLI_Interface(void * b_v, std::vector<const char *> a, bool ta, const char * hm = "");
 	virtual ~CLI_Interface() = default;
@@ -18,6 +31,41 @@ public:
 	bool ignored() const;
 	const char * get_help_message() const;
 	virtual void set_base_variable(const char * b_v) = 0;
+	// Called for a short option repeated count times in one argument, as in
+	// -vvv, with the letter as alias. The default converts the count to a
+	// string for set_base_variable, which counters and flag words skip.
+	virtual void set_repetitions(Arg_View alias, size_t count);
+
+	// Options that validate their values report an invalid one by returning
+	// false instead of throwing, and only build the message if it is asked for.
+	virtual bool try_set_base_variable(const char * b_v);
+	virtual std::string invalid_value_message(Arg_View value) const;
+
+	// Options that append every value to a container can have their values
+	// converted independently of each other. append_slots makes room for n
+	// more values and returns the position of the first one, and set_slot
+	// converts a value into one of those positions.
+	virtual bool appends() const;
+	virtual size_t append_slots(size_t n);
+	virtual void set_slot(size_t slot, const char * b_v);
+	// Options whose conversion touches state shared with other options, such
+	// as an Intern_Pool, return false and are converted while parse_parallel
+	// splits up the command line instead.
+	virtual bool converts_in_parallel() const;
+	// Actions run their function and return true, which ends parsing. Every
+	// other option returns false.
+	virtual bool run_action(Parser& p);
+
+	// Saves the bound variable into a snapshot image, or only measures it if
+	// out is null, and returns the number of bytes. Options that cannot be
+	// saved write nothing. read_snapshot restores the variable from exactly
+	// the bytes that were written.
+	virtual size_t write_snapshot(char * out) const;
+	virtual bool read_snapshot(const char * data, size_t size);
+
+	// Writes the arguments that would set the bound variable to its current
+	// value, for Parser::make_argv. Options that cannot write nothing.
+	virtual void write_arguments(Argv_Writer& writer) const;
 };
 
 template<typename T>
@@ -26,6 +74,9 @@ public:
 	Var(T & b_v, std::vector<const char *> a, bool ta, const char * hm = "");
 	Var(T * b_v, std::vector<const char *> a, bool ta, const char * hm = "");
 	virtual void set_base_variable(const char * b_v);
+	virtual size_t write_snapshot(char * out) const;
+	virtual bool read_snapshot(const char * data, size_t size);
+	virtual void write_arguments(Argv_Writer& writer) const;
 };
 
 template<typename T>
@@ -34,6 +85,12 @@ public:
 	Vector(std::vector<T>& b_v, std::vector<const char *> a, const char * hm = "");
 	Vector(std::vector<T>* b_v, std::vector<const char *> a, const char * hm = "");
 	virtual void set_base_variable(const char * b_v);
+	virtual bool appends() const;
+	virtual size_t append_slots(size_t n);
+	virtual void set_slot(size_t slot, const char * b_v);
+	virtual size_t write_snapshot(char * out) const;
+	virtual bool read_snapshot(const char * data, size_t size);
+	virtual void write_arguments(Argv_Writer& writer) const;
 };
 
 template<typename T>
@@ -44,6 +101,105 @@ public:
 	Value(T & b_v, std::vector<const char *> a, T v, const char * hm = "");
 	Value(T * b_v, std::vector<const char *> a, T v, const char * hm = "");
 	virtual void set_base_variable(const char * b_v);
+	virtual size_t write_snapshot(char * out) const;
+	virtual bool read_snapshot(const char * data, size_t size);
+	virtual void write_arguments(Argv_Writer& writer) const;
+};
+
+// Adds one to an integer every time the flag is given, and the count for
+// -vvv, so "-vv -v" counts to three. Nothing is converted from a string.
+template<typename T>
+class Count : public CLI_Interface {
+	static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value, "Count needs an integer type.");
+public:
+	Count(T & b_v, std::vector<const char *> a, const char * hm = "");
+	virtual void set_base_variable(const char * b_v);
+	virtual void set_repetitions(Arg_View alias, size_t count);
+	virtual size_t write_snapshot(char * out) const;
+	virtual bool read_snapshot(const char * data, size_t size);
+	virtual void write_arguments(Argv_Writer& writer) const;
+};
+
+// Adds every value given to the flag to a number, so "-w 2 -w 3" gives 5.
+// Values are converted with the Var<T> specializations.
+template<typename T>
+class Sum : public CLI_Interface {
+	static_assert(std::is_arithmetic<T>::value, "Sum needs an arithmetic type.");
+public:
+	Sum(T & b_v, std::vector<const char *> a, const char * hm = "");
+	virtual void set_base_variable(const char * b_v);
+	virtual size_t write_snapshot(char * out) const;
+	virtual bool read_snapshot(const char * data, size_t size);
+	virtual void write_arguments(Argv_Writer& writer) const;
+};
+
+// Any number of boolean flags packed into one integer word. Each alias has its
+// own mask, which is ORed into the word when the alias is given, so a single
+// option stands for all of them and they are tested together with one AND.
+template<typename T>
+class Bits : public CLI_Interface {
+	static_assert(std::is_integral<T>::value, "Bits needs an integer type.");
+private:
+	View_Table<T> masks;
+public:
+	Bits(T & b_v, std::vector<std::pair<const char *, T>> b, const char * hm = "");
+	virtual void set_base_variable(const char * b_v);
+	virtual void set_repetitions(Arg_View alias, size_t count);
+	virtual size_t write_snapshot(char * out) const;
+	virtual bool read_snapshot(const char * data, size_t size);
+	virtual void write_arguments(Argv_Writer& writer) const;
+private:
+	static std::vector<const char *> bit_aliases(const std::vector<std::pair<const char *, T>>& b);
+};
+
+// Maps a fixed set of named values, as in --type=file|dir|link, to values of T
+// with a single lookup in a sorted table. The valid names are appended to the
+// help message automatically.
+template<typename T>
+class Choice : public CLI_Interface {
+private:
+	View_Table<T> choices;
+	std::string valid_values;
+	std::string choice_help_message;
+public:
+	Choice(T & b_v, std::vector<const char *> a, std::vector<std::pair<const char *, T>> c, const char * hm = "");
+	Choice(T * b_v, std::vector<const char *> a, std::vector<std::pair<const char *, T>> c, const char * hm = "");
+	virtual void set_base_variable(const char * b_v);
+	virtual bool try_set_base_variable(const char * b_v);
+	virtual std::string invalid_value_message(Arg_View value) const;
+	virtual size_t write_snapshot(char * out) const;
+	virtual bool read_snapshot(const char * data, size_t size);
+	virtual void write_arguments(Argv_Writer& writer) const;
+private:
+	void fill_choices(const std::vector<std::pair<const char *, T>>& c);
+};
+
+// Hands every argument to a function instead of storing it, so that values can
+// be processed as they arrive, such as with Parser::parse_stream.
+class Sink : public CLI_Interface {
+public:
+	typedef void (*argument_sink)(const char *, void *);
+private:
+	argument_sink sink;
+	void * sink_data;
+public:
+	Sink(argument_sink s, void * s_d, std::vector<const char *> a, const char * hm = "");
+	virtual void set_base_variable(const char * b_v);
+};
+
+// Calls a function the moment its flag is seen, given the parser that saw it,
+// after which nothing else on the command line is parsed, as for --help or
+// --version.
+class Action : public CLI_Interface {
+public:
+	typedef void (*action_func)(Parser&, void *);
+private:
+	action_func action;
+	void * action_data;
+public:
+	Action(action_func f, void * a_d, std::vector<const char *> a, const char * hm = "");
+	virtual void set_base_variable(const char * b_v);
+	virtual bool run_action(Parser& p);
 };
 
 template<>
@@ -54,6 +210,9 @@ public:
 	Var(char * b_v, std::vector<const char *> a, bool ta, int b_s, const char * hm = "");
 	Var(char & b_v, std::vector<const char *> a, bool ta, const char * hm = "");
 	virtual void set_base_variable(const char * b_v);
+	virtual size_t write_snapshot(char * out) const;
+	virtual bool read_snapshot(const char * data, size_t size);
+	virtual void write_arguments(Argv_Writer& writer) const;
 };
 
 }
@@ -0,0 +1,323 @@
+#ifndef ARGV_WRITER_H
+#define ARGV_WRITER_H
+#include "arg_view.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cli {
+
+// Builds an argv for execve in one allocation. Every option writes its
+// arguments twice: once to measure them, with nothing allocated, and once
+// into the buffer, which holds the pointers followed by the characters.
+class Argv_Writer {
+private:
+	char ** pointers;
+	char * characters;
+	size_t num_arguments;
+	size_t num_characters;
+private:
+	void begin_argument();
+	void append(const char * str, size_t length);
+	void end_argument();
+public:
+	Argv_Writer() : pointers(nullptr), characters(nullptr), num_arguments(0), num_characters(0) {}
+	Argv_Writer(char ** p, char * c) : pointers(p), characters(c), num_arguments(0), num_characters(0) {}
+	size_t arguments() const;
+	size_t size() const;
+
+	void argument(Arg_View arg);
+	// The canonical form of a flag is its first long alias, or its first
+	// short alias if it has no long one.
+	bool flag(const std::vector<const char *>& aliases);
+	// "--alias", or "-a" for a single character alias.
+	void flag_alias(const char * alias);
+	// "--alias=value" if there is a long alias and the value is not empty,
+	// otherwise "-a" followed by the value as its own argument.
+	bool flag_with_value(const std::vector<const char *>& aliases, Arg_View value);
+	// "-aaa" for a short alias a repeated count times.
+	bool repeated_flag(const std::vector<const char *>& aliases, size_t count);
+};
+
+inline const char * first_long_alias(const std::vector<const char *>& aliases) {
+	for (size_t i = 0; i < aliases.size(); i++) {
+		if (aliases[i][0] != '\0' && aliases[i][1] != '\0') {
+			return aliases[i];
+		}
+	}
+	return nullptr;
+}
+
+// "-" stands for standard input rather than a flag, so it never counts.
+inline const char * first_short_alias(const std::vector<const char *>& aliases) {
+	for (size_t i = 0; i < aliases.size(); i++) {
+		if (aliases[i][0] != '\0' && aliases[i][0] != '-' && aliases[i][1] == '\0') {
+			return aliases[i];
+		}
+	}
+	return nullptr;
+}
+
+inline void Argv_Writer::begin_argument() {
+	if (pointers != nullptr) {
+		pointers[num_arguments] = characters + num_characters;
+	}
+	num_arguments++;
+}
+
+inline void Argv_Writer::append(const char * str, size_t length) {
+	if (characters != nullptr) {
+		memcpy(characters + num_characters, str, length);
+	}
+	num_characters += length;
+}
+
+inline void Argv_Writer::end_argument() {
+	append("", 1);
+}
+
+inline size_t Argv_Writer::arguments() const {
+	return num_arguments;
+}
+
+inline size_t Argv_Writer::size() const {
+	return num_characters;
+}
+
+inline void Argv_Writer::argument(Arg_View arg) {
+	begin_argument();
+	append(arg.data, arg.length);
+	end_argument();
+}
+
+inline bool Argv_Writer::flag(const std::vector<const char *>& aliases) {
+	const char * alias = first_long_alias(aliases);
+	const char * prefix = "--";
+	if (alias == nullptr) {
+		alias = first_short_alias(aliases);
+		prefix = "-";
+	}
+	if (alias == nullptr) {
+		return false;
+	}
+	begin_argument();
+	append(prefix, strlen(prefix));
+	append(alias, strlen(alias));
+	end_argument();
+	return true;
+}
+
+inline void Argv_Writer::flag_alias(const char * alias) {
+	size_t length = strlen(alias);
+	begin_argument();
+	append("--", length == 1 ? 1 : 2);
+	append(alias, length);
+	end_argument();
+}
+
+inline bool Argv_Writer::flag_with_value(const std::vector<const char *>& aliases, Arg_View value) {
+	// A long option only takes its value after an '=', and "--alias=" counts
+	// as no value at all.
+	const char * alias = first_long_alias(aliases);
+	if (alias != nullptr && !value.empty()) {
+		begin_argument();
+		append("--", 2);
+		append(alias, strlen(alias));
+		append("=", 1);
+		append(value.data, value.length);
+		end_argument();
+		return true;
+	}
+	alias = first_short_alias(aliases);
+	if (alias == nullptr) {
+		return false;
+	}
+	begin_argument();
+	append("-", 1);
+	append(alias, 1);
+	end_argument();
+	argument(value);
+	return true;
+}
+
+inline bool Argv_Writer::repeated_flag(const std::vector<const char *>& aliases, size_t count) {
+	const char * alias = first_short_alias(aliases);
+	if (alias == nullptr || count == 0) {
+		return false;
+	}
+	begin_argument();
+	append("-", 1);
+	for (size_t i = 0; i < count; i++) {
+		append(alias, 1);
+	}
+	end_argument();
+	return true;
+}
+
+inline int format_number(char (&scratch)[64], float value) {
+	return snprintf(scratch, sizeof(scratch), "%.9g", value);
+}
+
+inline int format_number(char (&scratch)[64], double value) {
+	return snprintf(scratch, sizeof(scratch), "%.17g", value);
+}
+
+inline int format_number(char (&scratch)[64], long double value) {
+	return snprintf(scratch, sizeof(scratch), "%.21Lg", value);
+}
+
+template <typename T>
+inline int format_number(char (&scratch)[64], T value, typename std::enable_if<std::is_signed<T>::value && std::is_integral<T>::value>::type * = nullptr) {
+	return snprintf(scratch, sizeof(scratch), "%lld", (long long)value);
+}
+
+template <typename T>
+inline int format_number(char (&scratch)[64], T value, typename std::enable_if<std::is_unsigned<T>::value>::type * = nullptr) {
+	return snprintf(scratch, sizeof(scratch), "%llu", (unsigned long long)value);
+}
+
+// How a value of type T is written back as an argument. format returns false
+// if the value cannot be, and may use the scratch buffer for the characters.
+// Numbers are written so that converting them again gives the same value.
+// Specialize it for any other type you bind.
+template <typename T, bool = std::is_arithmetic<T>::value>
+struct Number_Argument_Format {
+	static bool format(const T& value, char (&scratch)[64], Arg_View& arg) {
+		(void)value;
+		(void)scratch;
+		(void)arg;
+		return false;
+	}
+};
+
+template <typename T>
+struct Number_Argument_Format<T, true> {
+	static bool format(const T& value, char (&scratch)[64], Arg_View& arg) {
+		arg = Arg_View(scratch, format_number(scratch, value));
+		return true;
+	}
+};
+
+template <typename T>
+struct Argument_Format : Number_Argument_Format<T> {};
+
+// A bool is set from any argument at all, so only true can be written back.
+template <>
+struct Argument_Format<bool> {
+	static bool format(const bool& value, char (&scratch)[64], Arg_View& arg) {
+		(void)scratch;
+		arg = Arg_View("1", 1);
+		return value;
+	}
+};
+
+template <>
+struct Argument_Format<char> {
+	static bool format(const char& value, char (&scratch)[64], Arg_View& arg) {
+		scratch[0] = value;
+		arg = Arg_View(scratch, 1);
+		return value != '\0';
+	}
+};
+
+template <>
+struct Argument_Format<std::string> {
+	static bool format(const std::string& value, char (&scratch)[64], Arg_View& arg) {
+		(void)scratch;
+		arg = Arg_View(value.data(), value.size());
+		return true;
+	}
+};
+
+template <>
+struct Argument_Format<const char *> {
+	static bool format(const char * value, char (&scratch)[64], Arg_View& arg) {
+		(void)scratch;
+		if (value == nullptr) {
+			return false;
+		}
+		arg = Arg_View(value);
+		return true;
+	}
+};
+
+template <>
+struct Argument_Format<Arg_View> {
+	static bool format(const Arg_View& value, char (&scratch)[64], Arg_View& arg) {
+		(void)scratch;
+		arg = value;
+		return true;
+	}
+};
+
+// Writes the value of an option that takes arguments, if it can be written.
+template <typename T>
+inline void write_flag_with_value(Argv_Writer& writer, const std::vector<const char *>& aliases, const T& value) {
+	char scratch[64];
+	Arg_View arg;
+	if (Argument_Format<T>::format(value, scratch, arg)) {
+		writer.flag_with_value(aliases, arg);
+	}
+}
+
+// Compares with == if T has it, so that any type can still be bound.
+template <typename T>
+inline auto argument_values_equal(const T& a, const T& b, int) -> decltype(bool(a == b)) {
+	return a == b;
+}
+
+template <typename T>
+inline bool argument_values_equal(const T& a, const T& b, long) {
+	(void)a;
+	(void)b;
+	return false;
+}
+
+// How many times a flag counted by a Parser::repeated option was given.
+template <typename T>
+inline size_t argument_repetitions(const T& value, typename std::enable_if<std::is_integral<T>::value>::type * = nullptr) {
+	return value > 0 ? (size_t)value : 0;
+}
+
+template <typename T>
+inline size_t argument_repetitions(const T& value, typename std::enable_if<!std::is_integral<T>::value>::type * = nullptr) {
+	(void)value;
+	return 0;
+}
+
+// The argv built by Parser::make_argv. The pointers and the characters they
+// point to share one allocation, which is freed with the Argv_Buffer.
+class Argv_Buffer {
+private:
+	char * memory;
+	int count;
+public:
+	Argv_Buffer(char * m, int c) : memory(m), count(c) {}
+	Argv_Buffer(Argv_Buffer&& other) : memory(other.memory), count(other.count) {
+		other.memory = nullptr;
+		other.count = 0;
+	}
+	Argv_Buffer& operator=(Argv_Buffer&& other) {
+		std::swap(memory, other.memory);
+		std::swap(count, other.count);
+		return *this;
+	}
+	Argv_Buffer(const Argv_Buffer&) = delete;
+	Argv_Buffer& operator=(const Argv_Buffer&) = delete;
+	~Argv_Buffer() {
+		delete[] memory;
+	}
+	// Null terminated, as execve expects.
+	char ** argv() const {
+		return (char **)memory;
+	}
+	int argc() const {
+		return count;
+	}
+};
+
+}
+#endif
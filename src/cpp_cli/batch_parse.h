@@ -0,0 +1,169 @@
+#ifndef BATCH_PARSE_H
+#define BATCH_PARSE_H
+#include "cpp_cli.h"
+#include "parallel_parse.h"
+#include <exception>
+#include <vector>
+
+namespace cli {
+
+// What became of one segment of a batch. The segment is the argc arguments
+// from argv[index], the first of which names its command. error is the error
+// in its command line, if any, with its index counted in the whole argv, and
+// the command only runs if there is none. If parsing the segment or running
+// its command throws, the exception is kept instead of being rethrown.
+struct Batch_Result {
+	const char * command = nullptr;
+	int index = 0;
+	int argc = 0;
+	Parse_Error error;
+	// Only filled for a command added with Parser::add_command. A subcommand
+	// parses its arguments itself.
+	std::vector<const char *> non_options;
+#ifdef CPP_CLI_EXCEPTIONS
+	std::exception_ptr exception;
+#endif
+
+	bool failed() const;
+};
+
+inline bool Batch_Result::failed() const {
+#ifdef CPP_CLI_EXCEPTIONS
+	if (exception) {
+		return true;
+	}
+#endif
+	return bool(error);
+}
+
+// Makes state the help settings, file name and command list of this thread.
+inline void use_help_state(const Help_Request& state, CLI_Help& help_manager) {
+	help_manager = state.settings;
+	CLI_Help::help_file_name() = state.file_name;
+	CLI_Help::current_command_list() = state.command_list;
+}
+
+// Runs one segment, either by calling its subcommand or by building its
+// command on a parser of its own, parsing the rest of the segment with it and
+// running it. Nested commands are selected the same way as with parse. help is
+// the help state the segment starts from. sub_argv is the copy of the segment
+// the subcommand is called with.
+inline void run_batch_segment(Parser::subcommand_func sub_com, char ** sub_argv, const Command * command, const char * const * argv, const Help_Request& help, Batch_Result& result, void * data) {
+	use_help_state(help, Parser::help_manager());
+	const char * const * segment = argv + result.index;
+	CLI_TRY {
+		if (sub_com != nullptr) {
+			sub_com(result.argc, sub_argv, data);
+			return;
+		}
+		Parser command_parser;
+		command->build(command_parser, data);
+		command_parser.parse_arguments(result.argc, segment, data);
+		if (command_parser.error) {
+			result.error = command_parser.error;
+			if (result.error.index >= 0) {
+				result.error.index += result.index;
+			}
+		} else if (command_parser.action_option == nullptr) {
+			if (command_parser.selected_parser != nullptr) {
+				command_parser.run_selected_command(data);
+			} else if (command->run != nullptr) {
+				command->run(command_parser, data);
+			}
+		}
+		result.non_options.assign(command_parser.non_options.begin(), command_parser.non_options.end());
+	} CLI_CATCH_ALL {
+#ifdef CPP_CLI_EXCEPTIONS
+		result.exception = std::current_exception();
+#endif
+	}
+}
+
+// Splits the command line on every argument equal to separator, such as the
+// ";" of "tool fetch a \; index b \; verify c", and runs each segment as a
+// command line of its own on up to num_threads threads. The first argument of
+// a segment names a command or subcommand of p, which are all looked up
+// before any segment runs, and empty segments are skipped. The results are in
+// command line order, whatever order the segments finished in, and a failed
+// segment does not stop the others.
+//
+// A subcommand function gets a copy of its segment's pointers ending in a
+// null, like the argv of main, so it may reorder them, by passing them on to
+// parse_levels for example, without touching argv or the other segments. The
+// arguments themselves are still argv's, with their const cast away.
+//
+// The segments are independent: options of p, global ones included, are not
+// accepted in them, and every command is built on a parser using the default
+// memory resource rather than p's. Each thread starts every segment with the
+// help settings of the calling thread. Commands that share data, or the
+// variables of their options, have to synchronize on their own.
+inline std::vector<Batch_Result> parse_batch(Parser& p, int argc, const char * const * argv, const char * separator = ";", size_t num_threads = 1, void * data = nullptr) {
+	const Arg_View separator_view(separator);
+	std::vector<Batch_Result> results;
+	for (int begin = 1; begin < argc;) {
+		int end = begin;
+		while (end < argc && !(Arg_View(argv[end]) == separator_view)) {
+			end++;
+		}
+		if (end > begin) {
+			results.emplace_back();
+			results.back().command = argv[begin];
+			results.back().index = begin;
+			results.back().argc = end - begin;
+		}
+		begin = end + 1;
+	}
+
+	std::vector<Parser::subcommand_func> subcommands(results.size(), nullptr);
+	std::vector<const Command *> commands(results.size(), nullptr);
+	size_t sub_argv_size = 0;
+	for (size_t i = 0; i < results.size(); i++) {
+		Arg_View name(results[i].command);
+		if (!p.subcommand_aliases.empty()) {
+			subcommands[i] = p.find_subcommand(name);
+		}
+		if (subcommands[i] != nullptr) {
+			sub_argv_size += results[i].argc + 1;
+		}
+		if (subcommands[i] == nullptr && !p.commands.empty()) {
+			commands[i] = p.find_command(name);
+		}
+		if (subcommands[i] == nullptr && commands[i] == nullptr) {
+			results[i].error.code = Parse_Error_Code::unknown_command;
+			results[i].error.index = results[i].index;
+			results[i].error.token = name;
+		}
+	}
+
+	// Every subcommand segment is copied into the one array, each followed by
+	// its null.
+	std::vector<char *> sub_argv(sub_argv_size);
+	std::vector<size_t> sub_argv_offsets(results.size(), 0);
+	size_t sub_argv_end = 0;
+	for (size_t i = 0; i < results.size(); i++) {
+		if (subcommands[i] == nullptr) {
+			continue;
+		}
+		sub_argv_offsets[i] = sub_argv_end;
+		for (int j = 0; j < results[i].argc; j++) {
+			sub_argv[sub_argv_end++] = const_cast<char *>(argv[results[i].index + j]);
+		}
+		sub_argv[sub_argv_end++] = nullptr;
+	}
+
+	// The calling thread runs segments as well, so its help state is put back
+	// once they are done.
+	const Help_Request caller_help = { Parser::help_manager(), CLI_Help::help_file_name(), CLI_Help::current_command_list() };
+	parallel_for(results.size(), num_threads == 0 ? 1 : num_threads, [&](size_t i) {
+		if (results[i].error) {
+			return;
+		}
+		char ** segment_argv = subcommands[i] != nullptr ? &sub_argv[sub_argv_offsets[i]] : nullptr;
+		run_batch_segment(subcommands[i], segment_argv, commands[i], argv, caller_help, results[i], data);
+	}, 1);
+	use_help_state(caller_help, Parser::help_manager());
+	return results;
+}
+
+}
+#endif
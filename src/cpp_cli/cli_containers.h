@@ -0,0 +1,93 @@
+#ifndef CLI_CONTAINERS_H
+#define CLI_CONTAINERS_H
+#include "cli_errors.h"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#ifdef CPP_CLI_PMR
+#include <memory_resource>
+#endif
+
+namespace cli {
+
+// The containers the library uses internally. Defining CPP_CLI_PMR before
+// including any cpp_cli header, which needs C++17, makes them the std::pmr
+// containers, so that a Parser constructed with a std::pmr::memory_resource
+// takes all of its memory from that resource. Otherwise they are the usual
+// containers and the resource pointers are always null.
+#ifdef CPP_CLI_PMR
+typedef std::pmr::memory_resource cli_memory_resource;
+typedef std::pmr::string cli_string;
+template <typename T>
+using cli_vector = std::pmr::vector<T>;
+template <typename K, typename V, typename H = std::hash<K>>
+using cli_hash_map = std::pmr::unordered_map<K, V, H>;
+template <typename K, typename H = std::hash<K>>
+using cli_hash_set = std::pmr::unordered_set<K, H>;
+
+inline cli_memory_resource * default_memory_resource() {
+	return std::pmr::get_default_resource();
+}
+
+template <typename T, typename... Args>
+inline T * cli_new(cli_memory_resource * resource, Args&&... args) {
+	void * memory = resource->allocate(sizeof(T), alignof(T));
+	CLI_TRY {
+		return new (memory) T(std::forward<Args>(args)...);
+	} CLI_CATCH_ALL {
+		resource->deallocate(memory, sizeof(T), alignof(T));
+		CLI_RETHROW;
+	}
+}
+
+template <typename C>
+inline C make_container(cli_memory_resource * resource) {
+	return C(resource);
+}
+
+// T has to be the type the object was created as.
+template <typename T>
+inline void cli_delete(cli_memory_resource * resource, T * object) {
+	if (object != nullptr) {
+		object->~T();
+		resource->deallocate(object, sizeof(T), alignof(T));
+	}
+}
+#else
+struct cli_memory_resource;
+typedef std::string cli_string;
+template <typename T>
+using cli_vector = std::vector<T>;
+template <typename K, typename V, typename H = std::hash<K>>
+using cli_hash_map = std::unordered_map<K, V, H>;
+template <typename K, typename H = std::hash<K>>
+using cli_hash_set = std::unordered_set<K, H>;
+
+inline cli_memory_resource * default_memory_resource() {
+	return nullptr;
+}
+
+template <typename T, typename... Args>
+inline T * cli_new(cli_memory_resource * resource, Args&&... args) {
+	(void)resource;
+	return new T(std::forward<Args>(args)...);
+}
+
+template <typename C>
+inline C make_container(cli_memory_resource * resource) {
+	(void)resource;
+	return C();
+}
+
+template <typename T>
+inline void cli_delete(cli_memory_resource * resource, T * object) {
+	(void)resource;
+	delete object;
+}
+#endif
+
+}
+#endif
@@ -0,0 +1,341 @@
+#ifndef CLI_DAEMON_H
+#define CLI_DAEMON_H
+#include "cli_errors.h"
+#include "cli_daemon_protocol.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char ** environ;
+
+namespace cli {
+
+// Handles one command line sent to serve, the same way main would, and
+// returns the exit status.
+typedef int (*daemon_handler)(int argc, char ** argv, void * data);
+
+// A command line received from a client. argv and environment point into
+// payload and are null terminated, and fds are the client's standard input,
+// output and error.
+struct Daemon_Request {
+	std::vector<char> payload;
+	std::vector<char *> argv;
+	std::vector<char *> environment;
+	const char * working_directory = nullptr;
+	int fds[CLI_DAEMON_NUM_FDS];
+};
+
+inline bool receive_all(int fd, char * data, size_t size) {
+	while (size > 0) {
+		ssize_t received = read(fd, data, size);
+		if (received < 0 && errno == EINTR) {
+			continue;
+		}
+		if (received <= 0) {
+			return false;
+		}
+		data += received;
+		size -= received;
+	}
+	return true;
+}
+
+// The client may be gone, which is not worth a SIGPIPE.
+inline bool send_all(int fd, const char * data, size_t size) {
+#ifdef MSG_NOSIGNAL
+	const int flags = MSG_NOSIGNAL;
+#else
+	const int flags = 0;
+#endif
+	while (size > 0) {
+		ssize_t sent = send(fd, data, size, flags);
+		if (sent < 0 && errno == EINTR) {
+			continue;
+		}
+		if (sent <= 0) {
+			return false;
+		}
+		data += sent;
+		size -= sent;
+	}
+	return true;
+}
+
+// Reads the header along with the descriptors attached to it, then the
+// payload, which is split up in place. Returns false if the connection ended
+// early or what came over it is not a valid request.
+inline bool receive_daemon_request(int connection, Daemon_Request& request) {
+	cli_daemon_request header;
+	union {
+		struct cmsghdr align;
+		char buffer[CMSG_SPACE(sizeof(int) * CLI_DAEMON_NUM_FDS)];
+	} control;
+	struct iovec iov;
+	iov.iov_base = &header;
+	iov.iov_len = sizeof(header);
+	struct msghdr message;
+	memset(&message, 0, sizeof(message));
+	message.msg_iov = &iov;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+	ssize_t received;
+	do {
+		received = recvmsg(connection, &message, 0);
+	} while (received < 0 && errno == EINTR);
+	if (received <= 0 || (message.msg_flags & MSG_CTRUNC) != 0) {
+		return false;
+	}
+	struct cmsghdr * cmsg = CMSG_FIRSTHDR(&message);
+	if (cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(sizeof(int) * CLI_DAEMON_NUM_FDS)) {
+		return false;
+	}
+	memcpy(request.fds, CMSG_DATA(cmsg), sizeof(request.fds));
+	if (!receive_all(connection, (char *)&header + received, sizeof(header) - received)) {
+		return false;
+	}
+	if (header.magic != CLI_DAEMON_MAGIC || header.version != CLI_DAEMON_VERSION || header.argc == 0 || header.payload_size == 0 || header.payload_size > CLI_DAEMON_MAX_PAYLOAD) {
+		return false;
+	}
+
+	request.payload.resize(header.payload_size);
+	if (!receive_all(connection, request.payload.data(), request.payload.size()) || request.payload.back() != '\0') {
+		return false;
+	}
+	std::vector<char *> strings;
+	strings.reserve((size_t)header.argc + header.envc + 1);
+	for (size_t begin = 0; begin < request.payload.size();) {
+		strings.push_back(request.payload.data() + begin);
+		begin += strlen(request.payload.data() + begin) + 1;
+	}
+	if (strings.size() != (size_t)header.argc + header.envc + 1) {
+		return false;
+	}
+	request.argv.assign(strings.begin(), strings.begin() + header.argc);
+	request.argv.push_back(nullptr);
+	request.environment.assign(strings.begin() + header.argc, strings.end() - 1);
+	request.environment.push_back(nullptr);
+	request.working_directory = strings.back();
+	return true;
+}
+
+// Runs in the process forked for a connection, which takes on the client's
+// descriptors, environment and working directory, and never returns. stdio is
+// flushed before it exits, but the destructors of the server's objects are not
+// run. The server sends the exit status back once the process has ended, so
+// it is still sent if the handler calls exit or is killed.
+[[noreturn]] inline void handle_daemon_connection(int connection, daemon_handler handler, void * data) {
+	Daemon_Request request;
+	if (!receive_daemon_request(connection, request)) {
+		_exit(1);
+	}
+	close(connection);
+	for (int i = 0; i < CLI_DAEMON_NUM_FDS; i++) {
+		if (request.fds[i] != i) {
+			dup2(request.fds[i], i);
+			close(request.fds[i]);
+		}
+	}
+	environ = request.environment.data();
+	if (chdir(request.working_directory) != 0) {
+		fprintf(stderr, "Could not change to the working directory %s: %s\n", request.working_directory, strerror(errno));
+		_exit(1);
+	}
+	int status = 1;
+#ifdef CPP_CLI_EXCEPTIONS
+	try {
+		status = handler((int)request.argv.size() - 1, request.argv.data(), data);
+	} catch (const std::exception& e) {
+		fprintf(stderr, "%s\n", e.what());
+	} catch (...) {}
+#else
+	status = handler((int)request.argv.size() - 1, request.argv.data(), data);
+#endif
+	fflush(nullptr);
+	_exit(status);
+}
+
+// The connection of a request being handled, kept open by the server until
+// the process handling it ends.
+struct Daemon_Connection {
+	pid_t pid;
+	int fd;
+};
+
+// The write end of the pipe that wakes serve up when a process ends. A signal
+// handler can only reach it through something like this.
+inline int& daemon_wakeup_fd() {
+	static int wakeup_fd = -1;
+	return wakeup_fd;
+}
+
+inline void daemon_child_ended(int signal_number) {
+	(void)signal_number;
+	int saved_errno = errno;
+	char byte = 0;
+	ssize_t written = write(daemon_wakeup_fd(), &byte, 1);
+	(void)written;
+	errno = saved_errno;
+}
+
+// Sends the exit status of every process that has ended to its client.
+inline void reap_daemon_connections(std::vector<Daemon_Connection>& connections) {
+	int status;
+	pid_t pid;
+	while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+		for (size_t i = 0; i < connections.size(); i++) {
+			if (connections[i].pid != pid) {
+				continue;
+			}
+			cli_daemon_reply reply;
+			reply.status = 1;
+			if (WIFEXITED(status)) {
+				reply.status = WEXITSTATUS(status);
+			} else if (WIFSIGNALED(status)) {
+				reply.status = 128 + WTERMSIG(status);
+			}
+			send_all(connections[i].fd, (const char *)&reply, sizeof(reply));
+			close(connections[i].fd);
+			connections[i] = connections.back();
+			connections.pop_back();
+			break;
+		}
+	}
+}
+
+[[noreturn]] inline void raise_daemon_error(const char * what, const char * socket_path) {
+	std::string error_message;
+	error_message.reserve(128);
+	error_message += what;
+	error_message += socket_path;
+	error_message += ": ";
+	error_message += strerror(errno);
+	raise_error<std::runtime_error>(error_message);
+}
+
+// Keeps the program running and handles the command lines that clients, such
+// as cli-client, send to the UNIX domain socket at socket_path. Each one is
+// handled in a process forked from this one, so whatever was set up before
+// calling serve, such as a Parser with its options and commands, is already
+// there, and nothing a command line changes lasts beyond it. handler is
+// called the same way main is, with the client's standard input, output and
+// error, environment and working directory, and its exit status is sent back
+// to the client.
+//
+// Only the user running the server can connect, since the socket is created
+// with permissions for its owner alone. A socket left behind at socket_path is
+// replaced. serve installs a SIGCHLD handler, which the processes handling
+// command lines put back to the default. It only returns by raising an error,
+// if the socket cannot be set up or accepting connections fails.
+inline void serve(const char * socket_path, daemon_handler handler, void * data = nullptr) {
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	size_t length = strlen(socket_path);
+	if (length == 0 || length >= sizeof(address.sun_path)) {
+		std::string error_message = "The socket path has to be shorter than a UNIX domain socket address: ";
+		error_message += socket_path;
+		raise_error<std::invalid_argument>(error_message);
+	}
+	memcpy(address.sun_path, socket_path, length + 1);
+
+	int wakeup[2];
+	if (pipe(wakeup) != 0) {
+		raise_daemon_error("Could not create a pipe to serve ", socket_path);
+	}
+	for (int i = 0; i < 2; i++) {
+		fcntl(wakeup[i], F_SETFD, FD_CLOEXEC);
+		fcntl(wakeup[i], F_SETFL, fcntl(wakeup[i], F_GETFL) | O_NONBLOCK);
+	}
+	daemon_wakeup_fd() = wakeup[1];
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = daemon_child_ended;
+	action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGCHLD, &action, nullptr);
+
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0) {
+		raise_daemon_error("Could not create a socket for ", socket_path);
+	}
+	fcntl(listener, F_SETFD, FD_CLOEXEC);
+	struct stat status;
+	if (lstat(socket_path, &status) == 0 && S_ISSOCK(status.st_mode)) {
+		unlink(socket_path);
+	}
+	mode_t previous_mask = umask(077);
+	int bound = bind(listener, (const struct sockaddr *)&address, sizeof(address));
+	umask(previous_mask);
+	if (bound != 0 || listen(listener, SOMAXCONN) != 0) {
+		int error = errno;
+		close(listener);
+		errno = error;
+		raise_daemon_error("Could not listen on ", socket_path);
+	}
+
+	std::vector<Daemon_Connection> connections;
+	struct pollfd polled[2];
+	polled[0].fd = listener;
+	polled[0].events = POLLIN;
+	polled[1].fd = wakeup[0];
+	polled[1].events = POLLIN;
+	for (;;) {
+		if (poll(polled, 2, -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			raise_daemon_error("Could not wait for connections on ", socket_path);
+		}
+		if (polled[1].revents != 0) {
+			char bytes[64];
+			while (read(wakeup[0], bytes, sizeof(bytes)) > 0) {}
+			reap_daemon_connections(connections);
+		}
+		if ((polled[0].revents & POLLIN) == 0) {
+			continue;
+		}
+		int connection = accept(listener, nullptr, nullptr);
+		if (connection < 0) {
+			if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN) {
+				continue;
+			}
+			raise_daemon_error("Could not accept connections on ", socket_path);
+		}
+		fcntl(connection, F_SETFD, FD_CLOEXEC);
+		pid_t pid = fork();
+		if (pid == 0) {
+			signal(SIGCHLD, SIG_DFL);
+			close(listener);
+			close(wakeup[0]);
+			close(wakeup[1]);
+			for (size_t i = 0; i < connections.size(); i++) {
+				close(connections[i].fd);
+			}
+			handle_daemon_connection(connection, handler, data);
+		}
+		if (pid < 0) {
+			close(connection);
+			continue;
+		}
+		connections.push_back({ pid, connection });
+	}
+}
+
+}
+#endif
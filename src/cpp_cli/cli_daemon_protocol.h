@@ -0,0 +1,34 @@
+#ifndef CLI_DAEMON_PROTOCOL_H
+#define CLI_DAEMON_PROTOCOL_H
+/* What cli::serve and its clients send each other over a UNIX domain socket.
+ * It is plain C, so that a client does not need a C++ compiler. Both ends run
+ * on the same machine, so every number is in its native byte order. */
+#include <stdint.h>
+
+#define CLI_DAEMON_MAGIC 0x494c4343u
+#define CLI_DAEMON_VERSION 1u
+/* Standard input, output and error, in that order. */
+#define CLI_DAEMON_NUM_FDS 3
+/* The largest payload a server accepts. */
+#define CLI_DAEMON_MAX_PAYLOAD (16u * 1024u * 1024u)
+
+/* Sent once per connection by the client, with its standard input, output
+ * and error attached as SCM_RIGHTS. It is followed by payload_size bytes
+ * holding the argc arguments, then the envc environment entries, then the
+ * working directory, each terminated by a '\0'. */
+struct cli_daemon_request {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t argc;
+	uint32_t envc;
+	uint32_t payload_size;
+};
+
+/* Sent back once the command line has been handled. status is what the
+ * handler returned or passed to exit, or 128 plus the number of the signal
+ * that killed it, the way a shell reports it. */
+struct cli_daemon_reply {
+	int32_t status;
+};
+
+#endif
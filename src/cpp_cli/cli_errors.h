@@ -0,0 +1,55 @@
+#ifndef CLI_ERRORS_H
+#define CLI_ERRORS_H
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Exceptions are detected the way the compilers report them, so every header
+// also builds with -fno-exceptions. Without exceptions nothing is ever caught,
+// and raise_error prints its message to stderr and aborts. Use
+// Parser::try_parse to get command line errors back as values instead.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define CPP_CLI_EXCEPTIONS
+#endif
+
+// Programs that link the compiled library in src/cpp_cli_lib define
+// CPP_CLI_COMPILED in every translation unit. The headers then leave out the
+// definitions of the parser, its help and its options, which the library
+// compiles once, and the options for the built in types are not instantiated
+// again either. The library itself is compiled with CPP_CLI_LIBRARY, which
+// makes those definitions ordinary functions. Without either, every
+// definition is inline and the headers need nothing else.
+#ifdef CPP_CLI_LIBRARY
+#define CPP_CLI_INLINE
+#else
+#define CPP_CLI_INLINE inline
+#endif
+#if !defined(CPP_CLI_COMPILED) || defined(CPP_CLI_LIBRARY)
+#define CPP_CLI_DEFINITIONS
+#endif
+
+#ifdef CPP_CLI_EXCEPTIONS
+#define CLI_TRY try
+#define CLI_CATCH_ALL catch (...)
+#define CLI_RETHROW throw
+#else
+#define CLI_TRY if (true)
+#define CLI_CATCH_ALL else
+#define CLI_RETHROW
+#endif
+
+namespace cli {
+
+template <typename E>
+[[noreturn]] inline void raise_error(const std::string& error_message) {
+#ifdef CPP_CLI_EXCEPTIONS
+	throw E(error_message);
+#else
+	fputs(error_message.c_str(), stderr);
+	fputc('\n', stderr);
+	abort();
+#endif
+}
+
+}
+#endif
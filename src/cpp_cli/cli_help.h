@@ -1,25 +1,47 @@
 #ifndef CLI_HELP_H
 #define CLI_HELP_H
-#include <fstream>
+#include "cli_containers.h"
+#ifndef CPP_CLI_LEAN
 #include <iostream>
+#endif
+#include <cstdint>
 #include <string>
 #include <vector>
+#ifdef CPP_CLI_DEFINITIONS
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#endif
 
 class CLI_Interface;
 
 namespace cli {
+// Defining CPP_CLI_LEAN before including any cpp_cli header replaces every
+// stream with plain POSIX reads and writes, so the library neither includes
+// <iostream> nor constructs any stream objects. The shared state is kept in
+// function local statics, so including the library runs no constructors when
+// the program loads in either mode. The name of the help file being built and
+// the list of commands leading to it are kept per thread, while the help file
+// path is set once for the whole program.
 struct CLI_Help {
 public:
 	std::string header;
 	std::string usage;
 	std::string footer;
-	static std::string help_file_name;
-	static std::string help_file_path;
 	size_t help_width = 80;
-
-	static std::vector<const char *> current_command_list;
-	std::vector<const char *> subcommand_descriptions;
 public:
+	static std::string& help_file_name();
+	static std::string& help_file_path();
+	static std::vector<const char *>& current_command_list();
+
 	void set_usage(std::string u);
 	void set_header(std::string h);
 	void set_footer(std::string f);
@@ -27,86 +49,205 @@ public:
 	void set_help_file_name(std::string hfn);
 	void set_help_file_path(std::string hfp);
 
+	void append_within_length(std::string& buffer, const std::string& str, size_t indent = 0);
+#ifndef CPP_CLI_LEAN
 	void print_within_length_stream(const std::string& str, size_t indent = 0, std::ostream& file_writer = std::cout);
+#endif
 	std::string print_within_length_str(const std::string& str, size_t indent = 0);
 
-	void generate_help(const char * subcommand_name, std::vector<const char *> subcommand_aliases, std::vector<CLI_Interface *> list_of_cmd_var);
+	// generate_help names the help file of subcommand_name, builds its
+	// contents and writes it, unless the file already holds them. The steps
+	// are also available on their own, so that the file can be written later.
+	void generate_help(const char * subcommand_name, const cli_vector<const char *>& subcommand_aliases, const cli_vector<const char *>& subcommand_descriptions, const cli_vector<CLI_Interface *>& list_of_cmd_var);
+	void name_help_file(const char * subcommand_name);
+	uint64_t help_key(const std::vector<const char *>& command_list, const cli_vector<const char *>& subcommand_aliases, const cli_vector<const char *>& subcommand_descriptions, const cli_vector<CLI_Interface *>& list_of_cmd_var) const;
+	void build_help(std::string& contents, const std::vector<const char *>& command_list, const cli_vector<const char *>& subcommand_aliases, const cli_vector<const char *>& subcommand_descriptions, const cli_vector<CLI_Interface *>& list_of_cmd_var);
+	static bool help_file_current(const std::string& file_name, uint64_t key);
+	static void write_help_file(const std::string& file_name, const std::string& contents, uint64_t key);
 	void print_help();
 
 };
 
-inline void CLI_Help::set_header(std::string h) {
+// A help file named by generate_help that has yet to be written, with the
+// settings and the command list as they were when it was named, so that
+// changing them afterwards still has no effect on it.
+struct Help_Request {
+	CLI_Help settings;
+	std::string file_name;
+	std::vector<const char *> command_list;
+};
+
+#ifdef CPP_CLI_DEFINITIONS
+CPP_CLI_INLINE std::string& CLI_Help::help_file_name() {
+	static thread_local std::string help_file_name = "If you see this message, the help_file_name is not being set.";
+	return help_file_name;
+}
+
+CPP_CLI_INLINE std::string& CLI_Help::help_file_path() {
+	static std::string help_file_path = "`";
+	return help_file_path;
+}
+
+CPP_CLI_INLINE std::vector<const char *>& CLI_Help::current_command_list() {
+	static thread_local std::vector<const char *> current_command_list;
+	return current_command_list;
+}
+
+CPP_CLI_INLINE void CLI_Help::set_header(std::string h) {
 	header = h;
 }
 
-inline void CLI_Help::set_usage(std::string u) {
+CPP_CLI_INLINE void CLI_Help::set_usage(std::string u) {
 	usage = u;
 }
 
-inline void CLI_Help::set_footer(std::string f) {
+CPP_CLI_INLINE void CLI_Help::set_footer(std::string f) {
 	footer = f;
 }
 
-inline void CLI_Help::set_help_width(size_t hw) {
+CPP_CLI_INLINE void CLI_Help::set_help_width(size_t hw) {
 	help_width = hw;
 }
 
-inline void CLI_Help::set_help_file_name(std::string hfn) {
-	help_file_name = hfn;
+CPP_CLI_INLINE void CLI_Help::set_help_file_name(std::string hfn) {
+	help_file_name() = hfn;
+}
+
+CPP_CLI_INLINE void CLI_Help::set_help_file_path(std::string hfp) {
+	help_file_path() = hfp;
+}
+
+CPP_CLI_INLINE bool write_all(int fd, const char * data, size_t size) {
+	while (size > 0) {
+		ssize_t written = write(fd, data, size);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		data += written;
+		size -= written;
+	}
+	return true;
+}
+
+// Every help file starts with a line holding the key of what it was built
+// from, so that a file that is still current is neither built nor written
+// again. The line is always the same length and is not printed.
+const char help_file_magic[] = "cpp_cli help ";
+const size_t help_file_header_size = sizeof(help_file_magic) - 1 + 16 + 1;
+
+CPP_CLI_INLINE void format_help_file_header(char (&header)[help_file_header_size], uint64_t key) {
+	static const char digits[] = "0123456789abcdef";
+	memcpy(header, help_file_magic, sizeof(help_file_magic) - 1);
+	for (size_t i = 0; i < 16; i++) {
+		header[sizeof(help_file_magic) - 1 + i] = digits[(key >> (60 - 4 * i)) & 0xf];
+	}
+	header[help_file_header_size - 1] = '\n';
+}
+
+// FNV-1a, with the terminator hashed as well so that "ab", "c" and "a", "bc"
+// differ.
+CPP_CLI_INLINE uint64_t hash_help_string(uint64_t hash, const char * str) {
+	for (;; str++) {
+		hash = (hash ^ (unsigned char)*str) * 1099511628211ULL;
+		if (*str == '\0') {
+			return hash;
+		}
+	}
 }
 
-inline void CLI_Help::set_help_file_path(std::string hfp) {
-	help_file_path = hfp;
+CPP_CLI_INLINE uint64_t hash_help_string(uint64_t hash, const std::string& str) {
+	return hash_help_string(hash, str.c_str());
+}
+
+CPP_CLI_INLINE void CLI_Help::generate_help(const char * subcommand_name, const cli_vector<const char *>& subcommand_aliases, const cli_vector<const char *>& subcommand_descriptions, const cli_vector<CLI_Interface *>& list_of_cmd_var) {
+	name_help_file(subcommand_name);
+	uint64_t key = help_key(current_command_list(), subcommand_aliases, subcommand_descriptions, list_of_cmd_var);
+	if (help_file_current(help_file_name(), key)) {
+		return;
+	}
+	std::string contents;
+	build_help(contents, current_command_list(), subcommand_aliases, subcommand_descriptions, list_of_cmd_var);
+	write_help_file(help_file_name(), contents, key);
 }
 
-inline void CLI_Help::generate_help(const char * subcommand_name, std::vector<const char *> subcommand_aliases, std::vector<CLI_Interface *> list_of_cmd_var) {
+CPP_CLI_INLINE void CLI_Help::name_help_file(const char * subcommand_name) {
 	const size_t last_slash_idx = std::string(subcommand_name).find_last_of("\\/");
 	if (std::string::npos != last_slash_idx)
 	{
 		subcommand_name += last_slash_idx;
 	}
-	current_command_list.push_back(subcommand_name);
+	std::vector<const char *>& command_list = current_command_list();
+	command_list.push_back(subcommand_name);
 	std::string buffer;
 	buffer.reserve(2048);
-	if (help_file_path == "`") {
+	if (help_file_path() == "`") {
 		std::string error_message = "The help file path has not been set. "
 		"Use the command 'CLI_Help::set_help_file_path(std::string hfn)' to set a valid file path before calling generate_help. "
 		"The file path should be an absolute path if you want the program to run anywhere. "
 		"Only use a relative path if your executable can only be executed from one spot.";
-		throw std::runtime_error(error_message);
+		raise_error<std::runtime_error>(error_message);
 	}
-	buffer = help_file_path;
+	buffer = help_file_path();
 	buffer += ".";
-	for (size_t i = 0; i < current_command_list.size(); i++) {
-		buffer += current_command_list[i];
+	for (size_t i = 0; i < command_list.size(); i++) {
+		buffer += command_list[i];
 		buffer += "_";
 	}
 	buffer += "help_file";
 	set_help_file_name(buffer);
+}
 
-	std::ofstream file_writer;
-	file_writer.open(help_file_name);
-
-	if (!file_writer.is_open()) {
-		std::string error_message;
-		error_message.reserve(1024);
-		error_message += help_file_name;
-		error_message += " must be accessable by the current user.";
-		throw std::runtime_error(error_message);
+// Hashes everything build_help reads: the settings, the command list, the
+// subcommands and the aliases and help message of every option. The format
+// version is hashed first, so that changing build_help is only a matter of
+// bumping it.
+CPP_CLI_INLINE uint64_t CLI_Help::help_key(const std::vector<const char *>& command_list, const cli_vector<const char *>& subcommand_aliases, const cli_vector<const char *>& subcommand_descriptions, const cli_vector<CLI_Interface *>& list_of_cmd_var) const {
+	const uint64_t format_version = 1;
+	uint64_t hash = (14695981039346656037ULL ^ format_version) * 1099511628211ULL;
+	hash = hash_help_string(hash, usage);
+	hash = hash_help_string(hash, header);
+	hash = hash_help_string(hash, footer);
+	hash = (hash ^ (uint64_t)help_width) * 1099511628211ULL;
+	for (size_t i = 0; i < command_list.size(); i++) {
+		hash = hash_help_string(hash, command_list[i]);
+	}
+	hash = (hash ^ 0xff) * 1099511628211ULL;
+	for (size_t i = 0; i < subcommand_aliases.size() && i < subcommand_descriptions.size(); i++) {
+		hash = hash_help_string(hash, subcommand_aliases[i]);
+		hash = hash_help_string(hash, subcommand_descriptions[i]);
+	}
+	hash = (hash ^ 0xff) * 1099511628211ULL;
+	for (size_t i = 0; i < list_of_cmd_var.size(); i++) {
+		const std::vector<const char *>& aliases = list_of_cmd_var[i]->get_aliases();
+		for (size_t j = 0; j < aliases.size(); j++) {
+			hash = hash_help_string(hash, aliases[j]);
+		}
+		hash = (hash ^ 0xff) * 1099511628211ULL;
+		hash = hash_help_string(hash, list_of_cmd_var[i]->get_help_message());
 	}
+	return hash;
+}
+
+CPP_CLI_INLINE void CLI_Help::build_help(std::string& contents, const std::vector<const char *>& command_list, const cli_vector<const char *>& subcommand_aliases, const cli_vector<const char *>& subcommand_descriptions, const cli_vector<CLI_Interface *>& list_of_cmd_var) {
+	std::string buffer;
+	buffer.reserve(2048);
+	contents.reserve(4096);
 
 	buffer = "usage: ";
-	for (size_t i = 0; i < current_command_list.size(); i++) {
-		buffer += current_command_list[i];
+	for (size_t i = 0; i < command_list.size(); i++) {
+		buffer += command_list[i];
 		buffer += " ";
 	}
 
 	buffer += usage;
 
-	print_within_length_stream(buffer, 0, file_writer);
-	file_writer << "\n";
-	print_within_length_stream(header, 0, file_writer);
-	file_writer << "\n";
+	append_within_length(contents, buffer, 0);
+	contents += "\n";
+	append_within_length(contents, header, 0);
+	contents += "\n";
 
 	bool any_descriptions = false;
 
@@ -115,17 +256,18 @@ inline void CLI_Help::generate_help(const char * subcommand_name, std::vector<co
 	}
 
 	if (any_descriptions) {
-		file_writer << "SUBCOMMANDS:\n";
+		contents += "SUBCOMMANDS:\n";
 		for (size_t i = 0; i < subcommand_descriptions.size(); i++) {
 			if (subcommand_descriptions[i][0] != '`') {
-				file_writer << subcommand_aliases[i] << "\n";
-				print_within_length_stream(subcommand_descriptions[i], 8, file_writer);
+				contents += subcommand_aliases[i];
+				contents += "\n";
+				append_within_length(contents, subcommand_descriptions[i], 8);
 			}
 		}
-		file_writer << "\n";
+		contents += "\n";
 	}
 
-	file_writer << "OPTIONS:\n";
+	contents += "OPTIONS:\n";
 	for (size_t i = 0; i < list_of_cmd_var.size(); i++) {
 		CLI_Interface * clv = list_of_cmd_var[i];
 		const std::vector<const char *>& a = clv->get_aliases();
@@ -141,78 +283,157 @@ inline void CLI_Help::generate_help(const char * subcommand_name, std::vector<co
 			buffer.pop_back();
 			buffer.pop_back();
 
-			file_writer << buffer << "\n";
-			print_within_length_stream(std::string(clv->get_help_message()), 8, file_writer);
+			contents += buffer;
+			contents += "\n";
+			append_within_length(contents, std::string(clv->get_help_message()), 8);
+		}
+	}
+	contents += "\n";
+	append_within_length(contents, footer, 0);
+}
+
+// Reads just the first line, which is all it takes to know that nothing has
+// to be written.
+CPP_CLI_INLINE bool CLI_Help::help_file_current(const std::string& file_name, uint64_t key) {
+	int fd = open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return false;
+	}
+	char expected[help_file_header_size];
+	char found[help_file_header_size];
+	format_help_file_header(expected, key);
+	ssize_t bytes_read;
+	do {
+		bytes_read = pread(fd, found, sizeof(found), 0);
+	} while (bytes_read < 0 && errno == EINTR);
+	close(fd);
+	return bytes_read == (ssize_t)sizeof(found) && memcmp(expected, found, sizeof(found)) == 0;
+}
+
+// Written to a file of its own first and renamed over the help file, so that
+// programs running at the same time, on the same machine or sharing the
+// directory over NFS, never see a partly written one.
+CPP_CLI_INLINE void CLI_Help::write_help_file(const std::string& file_name, const std::string& contents, uint64_t key) {
+	static std::atomic<unsigned int> temporary_files(0);
+	char suffix[64];
+	snprintf(suffix, sizeof(suffix), ".%ld.%u.tmp", (long)getpid(), temporary_files.fetch_add(1));
+	std::string temporary_name = file_name + suffix;
+	char header[help_file_header_size];
+	format_help_file_header(header, key);
+
+	int fd = open(temporary_name.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+	bool written = fd >= 0 && write_all(fd, header, sizeof(header)) && write_all(fd, contents.data(), contents.size());
+	if (fd >= 0 && close(fd) != 0) {
+		written = false;
+	}
+	if (!written || rename(temporary_name.c_str(), file_name.c_str()) != 0) {
+		if (fd >= 0) {
+			unlink(temporary_name.c_str());
 		}
+		std::string error_message;
+		error_message.reserve(1024);
+		error_message += file_name;
+		error_message += " must be accessable by the current user.";
+		raise_error<std::runtime_error>(error_message);
 	}
-	file_writer << "\n";
-	print_within_length_stream(footer, 0, file_writer);
-	file_writer.close();
 }
 
-inline void CLI_Help::print_help() {
-	std::ifstream file_reader;
-	file_reader.open(help_file_name);
-	if (!file_reader.is_open()) {
+// Hands the file to standard output in one sendfile where it can, or copies
+// it through a buffer otherwise. Anything already written to std::cout or
+// stdout is flushed first, so that it still comes before the help.
+CPP_CLI_INLINE void CLI_Help::print_help() {
+	int fd = open(help_file_name().c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
 		std::string error_message;
 		error_message.reserve(1024);
 		error_message += "\"";
-		error_message += help_file_name;
+		error_message += help_file_name();
 		error_message += "\" in \"";
-		error_message += help_file_path;
+		error_message += help_file_path();
 		error_message += "\"";
-		if (help_file_path == "") {
+		if (help_file_path() == "") {
 			error_message += " (current running directory)";
 		}
 		error_message += " has not been generated. Please put CLI_Help::generate_help(argv[0]) right before calling parse in the subcommand: ";
-		for (size_t i = 0; i < error_message.size(); i++) {
-			error_message += current_command_list[i];
+		for (size_t i = 0; i < current_command_list().size(); i++) {
+			error_message += current_command_list()[i];
 			error_message += "->";
 		}
 		error_message.pop_back();
 		error_message.pop_back();
-		throw std::runtime_error(error_message);
-	} else {
-		std::string line;
-		while (std::getline(file_reader, line)) {
-			std::cout << line << "\n";
+		raise_error<std::runtime_error>(error_message);
+	}
+	// A file written some other way is printed whole.
+	char header[help_file_header_size];
+	off_t offset = 0;
+	if (pread(fd, header, sizeof(header), 0) == (ssize_t)sizeof(header) && memcmp(header, help_file_magic, sizeof(help_file_magic) - 1) == 0) {
+		offset = sizeof(header);
+	}
+	struct stat status;
+	off_t end = fstat(fd, &status) == 0 ? status.st_size : 0;
+#ifndef CPP_CLI_LEAN
+	std::cout.flush();
+#endif
+	fflush(stdout);
+#ifdef __linux__
+	while (offset < end) {
+		ssize_t sent = sendfile(STDOUT_FILENO, fd, &offset, end - offset);
+		if (sent < 0 && errno == EINTR) {
+			continue;
+		}
+		if (sent <= 0) {
+			break;
+		}
+	}
+#endif
+	char chunk[4096];
+	while (offset < end) {
+		ssize_t bytes_read = pread(fd, chunk, sizeof(chunk), offset);
+		if (bytes_read < 0 && errno == EINTR) {
+			continue;
+		}
+		if (bytes_read <= 0 || !write_all(STDOUT_FILENO, chunk, bytes_read)) {
+			break;
 		}
+		offset += bytes_read;
 	}
-	file_reader.close();
+	close(fd);
 }
 
-void CLI_Help::print_within_length_stream(const std::string& str, size_t indent, std::ostream& stream) {
+CPP_CLI_INLINE void CLI_Help::append_within_length(std::string& buffer, const std::string& str, size_t indent) {
 	size_t cur_index = 0;
-	std::string indent_str(indent, ' ');
 	while (cur_index + help_width < str.length()) {
 		size_t line_length = str.find_last_of(" \t", cur_index + help_width - indent);
 		size_t next_newline = str.find("\n", cur_index);
 		if (next_newline < line_length) {
 			line_length = next_newline;
 		}
-		stream << indent_str << str.substr(cur_index, line_length - cur_index) << "\n";
+		buffer.append(indent, ' ');
+		buffer.append(str, cur_index, line_length - cur_index);
+		buffer += "\n";
 		cur_index = line_length + 1;
 	}
-	stream << std::string(indent, ' ') << str.substr(cur_index) << "\n";
+	buffer.append(indent, ' ');
+	buffer.append(str, cur_index, std::string::npos);
+	buffer += "\n";
 }
 
-std::string CLI_Help::print_within_length_str(const std::string& str, size_t indent) {
-	size_t cur_index = 0;
-	std::string next_str;
-	next_str.reserve(str.length());
-	while (cur_index < str.length()) {
-		size_t line_length = str.rfind(" ", cur_index + help_width - indent);
-		next_str += std::string(indent, ' ');
-		next_str += str.substr(cur_index, line_length - cur_index);
-		next_str += "\n";
-		cur_index += line_length + 1;
-	}
-	return next_str;
+#ifndef CPP_CLI_LEAN
+CPP_CLI_INLINE void CLI_Help::print_within_length_stream(const std::string& str, size_t indent, std::ostream& stream) {
+	std::string buffer;
+	buffer.reserve(str.length() + 64);
+	append_within_length(buffer, str, indent);
+	stream << buffer;
 }
+#endif
 
-std::string CLI_Help::help_file_path = "`";
-std::string CLI_Help::help_file_name = "If you see this message, the help_file_name is not being set.";
-std::vector<const char *> CLI_Help::current_command_list = std::vector<const char *>();
+CPP_CLI_INLINE std::string CLI_Help::print_within_length_str(const std::string& str, size_t indent) {
+	std::string buffer;
+	buffer.reserve(str.length() + 64);
+	append_within_length(buffer, str, indent);
+	return buffer;
+}
+#endif
 }
 
 #endif
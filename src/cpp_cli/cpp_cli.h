@@ -1,8 +1,20 @@
 #ifndef CPP_CMD_LINE_PARSER_H
 #define CPP_CMD_LINE_PARSER_H
 #include "args_parser_templates.h"
+#include "arg_token.h"
 #include "template_definitions.h"
 #include "cli_help.h"
+#include "parse_result.h"
+#include "parse_error.h"
+#include "snapshot.h"
+#include "interned.h"
+#include "cli_containers.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
 #include <unordered_map>
 #include <string>
 #include <stdexcept>
@@ -10,40 +22,226 @@
 
 namespace cli{
 	
+class Parser;
+struct Batch_Result;
+
+// A subcommand declared with Parser::add_command. build registers the
+// command's options and nested commands on a fresh Parser, and is only called
+// if the command is on the command line. run is called once the whole
+// command line has been parsed.
+struct Command {
+	typedef void (*command_func)(Parser&, void *);
+	const char * name;
+	command_func build;
+	command_func run;
+};
+
+// The value of an option that takes arguments, recorded while the command
+// line is being split up so that it can be converted later.
+struct Deferred_Value {
+	CLI_Interface * option;
+	const char * value;
+	int index;
+};
+
+enum class Option_Source : uint8_t {
+	// The variable still has whatever value it had before parsing.
+	unset,
+	command_line,
+	stream
+};
+
+// Where an option was last set from. index is the argv index of the argument
+// that set it, which is the one holding the value for an option that takes
+// one, counted from the argv given to the outermost parse, or the position of
+// the argument in the stream for parse_stream.
+struct Option_Record {
+	int index;
+	Option_Source source;
+};
+
+// A constraint declared on a Parser. Its members are options of that parser,
+// which are turned into a bitmask over the seen options the first time it is
+// checked.
+struct Option_Constraint {
+	enum Kind : uint8_t {
+		// Every member has to be seen.
+		required,
+		// At most one member may be seen.
+		exclusive,
+		// If subject is seen, every member has to be.
+		dependency
+	};
+	Kind kind;
+	uint32_t subject;
+	size_t first_member;
+	size_t num_members;
+};
+
 class Parser {
 friend class CLI_Interface;
 public:
 	typedef void (*subcommand_func)(int, char **, void *);
+	typedef void (*deferred_value_converter)(Parser&);
+	typedef void (*argument_sink)(const char *, void *);
+	typedef Command::command_func command_func;
+	typedef Action::action_func action_func;
+	typedef bool (*option_filter)(const CLI_Interface *, void *);
 private:
-	std::unordered_map<std::string, CLI_Interface *> command_line_settings_map;
-	std::vector<CLI_Interface *> list_of_cmd_var;
-	std::vector<const char *> non_options;
+	// Where every container and option of this parser gets its memory from.
+	// Always null unless CPP_CLI_PMR is defined.
+	cli_memory_resource * resource = default_memory_resource();
+
+	// Keyed by views of the aliases, which outlive the parser, so looking up
+	// a view of an argument builds no string.
+	cli_hash_map<Arg_View, CLI_Interface *, Arg_View_Hash> command_line_settings_map;
+	cli_vector<CLI_Interface *> list_of_cmd_var;
+	// The tables are filled the first time something is looked up in them,
+	// so a parse that an action ends before that never fills them.
+	bool options_indexed = false;
+	bool subcommands_indexed = false;
+	cli_vector<const char *> non_options;
 
-	std::unordered_map<std::string, subcommand_func> subcommand_map;
-	std::vector<subcommand_func> subcommand_list;
-	std::vector<const char *> subcommand_aliases;
+	cli_hash_map<Arg_View, subcommand_func, Arg_View_Hash> subcommand_map;
+	cli_vector<subcommand_func> subcommand_list;
+	cli_vector<const char *> subcommand_aliases;
+	// The subcommands and commands in the order they were added, for help.
+	cli_vector<const char *> subcommand_help_names;
+	cli_vector<const char *> subcommand_descriptions;
+
+	cli_vector<Command> commands;
+	View_Table<size_t> command_table;
+	// The aliases of the actions of this parser, which are looked up in here
+	// before anything else.
+	View_Table<CLI_Interface *> action_table;
+	// The action that ended the last parse, if any.
+	const CLI_Interface * action_option = nullptr;
+	// Written once parsing is done, or by print_help.
+	Help_Request pending_help;
+	bool help_pending = false;
+	// Options of supercommands that are accepted here too. They belong to
+	// the supercommands, so they are not deleted with this parser.
+	cli_vector<CLI_Interface *> inherited_options;
+	// The inherited options plus the options marked global here, which is
+	// what the parser of a selected command inherits.
+	cli_vector<CLI_Interface *> global_options;
+	const Command * selected_command = nullptr;
+	Parser * selected_parser = nullptr;
+	void * state = nullptr;
+	void (*state_deleter)(cli_memory_resource *, void *) = nullptr;
+#ifdef CPP_CLI_PMR
+	// The options are deleted through CLI_Interface pointers, so the size
+	// they were allocated with has to be kept.
+	struct Option_Memory {
+		void * memory;
+		size_t size;
+		size_t alignment;
+	};
+	cli_vector<Option_Memory> option_memory;
+#endif
 
 	size_t num_unique_flags = 0;
 
-	static CLI_Help help_manager;
+	// Set by parse_parallel. While set, the values of options that take
+	// arguments are recorded instead of converted.
+	deferred_value_converter deferred_converter = nullptr;
+	cli_vector<Deferred_Value> deferred_values;
+	size_t num_conversion_threads = 1;
+
+	// Set by parse_stream. While set, non-options go to the sink instead of
+	// non_options.
+	argument_sink non_option_sink = nullptr;
+	void * non_option_sink_data = nullptr;
+
+	// Set while this parser fills a level of a Parse_Result. Non-options are
+	// then moved to level_argv[1] onwards instead of being collected. Only
+	// parse_levels fills levels, and it is given a writable argv.
+	Parse_Result * filling = nullptr;
+	size_t level_index = 0;
+	char ** level_argv = nullptr;
+	int level_write = 1;
+	int level_dash_dash = -1;
+
+	// The first error of the last parse. Parsing stops as soon as it is set.
+	Parse_Error error;
+
+	// One record and one bit per option of this parser, set when the option
+	// is, no matter which parser sees it. Both are sized once per parse and
+	// reused, so recording allocates nothing.
+	cli_vector<Option_Record> option_records;
+	cli_vector<uint64_t> seen_options;
+	// What the arguments being parsed are recorded as, and where they start
+	// relative to the outermost argv, for the parser of a command.
+	Option_Source current_source = Option_Source::command_line;
+	int argv_offset = 0;
+
+	cli_vector<Option_Constraint> constraints;
+	cli_vector<uint32_t> constraint_members;
+	// A mask of seen_options.size() words per constraint, built from the
+	// members again whenever options were added since.
+	cli_vector<uint64_t> constraint_masks;
+	size_t constraint_masks_options = 0;
+
+	// The strings of the options bound to Interned variables.
+	Intern_Pool interned_strings;
+
+	// The classification of every argument of the last parse, reused so that
+	// it is only allocated when a longer command line comes along.
+	cli_vector<Arg_Token> arg_tokens;
+
+	static CLI_Help& help_manager();
+	static Parse_Result *& active_result();
 private:
+	template <typename D, typename... Args>
+	CLI_Interface * add_option(Args&&... args);
+	CLI_Interface * find_option(Arg_View alias);
+	void fail(Parse_Error_Code code, int index, Arg_View token, const char * flag_prefix, const CLI_Interface * option = nullptr, const CLI_Interface * other_option = nullptr);
+
 	void fill_hash_table();
 	void fill_subcommand_hash_table();
+	subcommand_func find_subcommand(Arg_View name);
+	CLI_Interface * find_action(const char * arg, const Arg_Token& token);
+	bool take_action(CLI_Interface * option);
+	void finish_parsing();
+	void write_pending_help();
+
+	void parse_arguments(int argc, const char * const * argv, void * data);
+	bool parse_argument(int argc, const char * const * argv, const Arg_Token * tokens, int& i, void * data);
+	void add_non_option(const char * arg);
 
-	void subcommand_handling(int argc, char ** argv, void * data);
+	void subcommand_handling(int argc, const char * const * argv, void * data);
+	const Command * find_command(Arg_View name);
+	void command_handling(const Command * command, int argc, const char * const * argv, const Arg_Token * tokens, void * data, int offset);
+	void run_selected_command(void * data);
+	void clear_selected_command();
+	void finish_level();
 
-	void long_option_handling(char ** argv, int& i);
-	int find_and_mark_split_location(char * flag);
-	void check_if_option_exists(const char * error_message, const char * flag, const bool exists, const bool should_exist);
+	void set_option(CLI_Interface * option, const char * value, int index);
+	void record_option(CLI_Interface * option, int index);
+	void reset_option_records();
 
-	void short_option_handling(int argc, char ** argv, int& i);
-	void multiple_short_options_handling(int argc, char ** argv, int& cur_argument);
+	uint32_t constrained_option(const CLI_Interface * option) const;
+	void add_constraint(Option_Constraint::Kind kind, uint32_t subject, const std::vector<CLI_Interface *>& members);
+	void compile_constraints();
+	void check_constraints();
+	int relative_index(uint32_t option) const;
+
+	void long_option_handling(const char * const * argv, const Arg_Token& token, int& i);
+
+	void short_option_handling(int argc, const char * const * argv, const Arg_Token& token, int& i);
+	void multiple_short_options_handling(int argc, const char * const * argv, const Arg_Token& token, int& cur_argument);
+
+	uint64_t schema_hash() const;
+	void write_argv(Argv_Writer& writer, const char * program, option_filter filter, void * filter_data, const char * const * positionals, size_t num_positionals) const;
 
 	void clear_everything();
 	void clear_managed_vars();
 
 	void print_flags();
 public:
+#ifdef CPP_CLI_PMR
+	explicit Parser(cli_memory_resource * r = default_memory_resource());
+#endif
 	~Parser();
 	void set_usage(const std::string& u);
 	void set_header(const std::string& h);
@@ -54,305 +252,1314 @@ public:
 	void print_help();
 
 	void add_subcommand(const char * subcommand, subcommand_func sub_func, const char * description = "");
+	void add_command(const char * name, command_func build, command_func run, const char * description = "");
+	CLI_Interface * global(CLI_Interface * option);
+	template <typename T>
+	T& command_state();
 	void reserve_space_for_subcommand(size_t number_of_subcommand);
 
-	std::vector<const char *> parse(int argc, char ** argv, void * data = nullptr);
+	std::vector<const char *> parse(int argc, const char * const * argv, void * data = nullptr);
+	Parse_Error try_parse(int argc, const char * const * argv, void * data = nullptr);
+	const cli_vector<const char *>& get_non_options() const;
+	Parse_Result parse_levels(int argc, char ** argv, void * data = nullptr);
+	void parse_stream(int fd, argument_sink sink, void * sink_data = nullptr, char delimiter = '\0', size_t buffer_size = 65536);
+
+	size_t save_snapshot(char * image);
+	bool load_snapshot(const char * image, size_t size);
+	void write_snapshot(int fd);
+
+	Argv_Buffer make_argv(const char * program, option_filter filter = nullptr, void * filter_data = nullptr, const char * const * positionals = nullptr, size_t num_positionals = 0) const;
 
 	template <typename T>
 	CLI_Interface * arg(T& var, std::vector<const char *> flags, const char * help_message = "");
+	CLI_Interface * arg(Interned& var, std::vector<const char *> flags, const char * help_message = "");
 
 	template <typename T>
 	CLI_Interface * value(T& var, std::vector<const char *> flags, T to_set, const char * help_message = "");
 
 	template <typename T>
 	CLI_Interface * vector(std::vector<T>& var, std::vector<const char *> flags, const char * help_message = "");
+	CLI_Interface * vector(std::vector<Interned>& var, std::vector<const char *> flags, const char * help_message = "");
+	Interned intern(Arg_View value);
 
+	template <typename T>
+	CLI_Interface * choice(T& var, std::vector<const char *> flags, std::vector<std::pair<const char *, T>> choices, const char * help_message = "");
+
+	CLI_Interface * sink(argument_sink sink, void * sink_data, std::vector<const char *> flags, const char * help_message = "");
 	CLI_Interface * ignored(std::vector<const char *> flags, const char * help_message = "");
 	CLI_Interface * repeated(size_t& var, std::vector<const char *> flags, const char * help_message = "");
+
+	template <typename T>
+	CLI_Interface * count(T& var, std::vector<const char *> flags, const char * help_message = "");
+	template <typename T>
+	CLI_Interface * sum(T& var, std::vector<const char *> flags, const char * help_message = "");
+	template <typename T>
+	CLI_Interface * bits(T& word, std::vector<std::pair<const char *, T>> bits, const char * help_message = "");
+	CLI_Interface * action(action_func function, void * action_data, std::vector<const char *> flags, const char * help_message = "");
+	const CLI_Interface * action_taken() const;
+
+	CLI_Interface * required(CLI_Interface * option);
+	void exclusive(std::vector<CLI_Interface *> options);
+	CLI_Interface * depends_on(CLI_Interface * option, std::vector<CLI_Interface *> dependencies);
+	bool seen(const CLI_Interface * option) const;
+	Option_Record provenance(const CLI_Interface * option) const;
+
+	friend std::vector<const char *> parse_parallel(Parser& p, int argc, const char * const * argv, size_t num_threads, void * data);
+	friend void convert_deferred_values(Parser& p);
+	friend void run_batch_segment(subcommand_func sub_com, char ** sub_argv, const Command * command, const char * const * argv, const Help_Request& help, Batch_Result& result, void * data);
+	friend std::vector<Batch_Result> parse_batch(Parser& p, int argc, const char * const * argv, const char * separator, size_t num_threads, void * data);
 };
 
-Parser::~Parser() {
+template <typename T>
+inline void delete_command_state(cli_memory_resource * resource, void * state) {
+	cli_delete(resource, static_cast<T *>(state));
+}
+
+// State owned by the parser of a command, created the first time it is asked
+// for. build binds options to it and run reads them back, which has to be
+// done with the same T.
+template <typename T>
+inline T& Parser::command_state() {
+	if (state == nullptr) {
+		state = cli_new<T>(resource);
+		state_deleter = delete_command_state<T>;
+	}
+	return *static_cast<T *>(state);
+}
+
+template <typename D, typename... Args>
+inline CLI_Interface * Parser::add_option(Args&&... args) {
+	list_of_cmd_var.reserve(list_of_cmd_var.size() + 1);
+#ifdef CPP_CLI_PMR
+	option_memory.reserve(option_memory.size() + 1);
+	D * option = cli_new<D>(resource, std::forward<Args>(args)...);
+	option_memory.push_back({ option, sizeof(D), alignof(D) });
+#else
+	D * option = cli_new<D>(resource, std::forward<Args>(args)...);
+#endif
+	option->owner = this;
+	option->option_index = (uint32_t)list_of_cmd_var.size();
+	list_of_cmd_var.push_back(option);
+	return option;
+}
+
+template <typename T>
+inline CLI_Interface * Parser::arg(T& var, std::vector<const char *> flags, const char * help_message) {
+	return add_option<Var<T>>(var, std::move(flags), true, help_message);
+}
+
+template <typename T>
+inline CLI_Interface * Parser::value(T& var, std::vector<const char *> flags, T to_set, const char * help_message) {
+	return add_option<Value<T>>(var, std::move(flags), to_set, help_message);
+}
+
+template <typename T>
+inline CLI_Interface * Parser::vector(std::vector<T>& var, std::vector<const char *> flags, const char * help_message) {
+	return add_option<Vector<T>>(var, std::move(flags), help_message);
+}
+
+template <typename T>
+inline CLI_Interface * Parser::choice(T& var, std::vector<const char *> flags, std::vector<std::pair<const char *, T>> choices, const char * help_message) {
+	return add_option<Choice<T>>(var, std::move(flags), std::move(choices), help_message);
+}
+
+// Counts up from the value var already has, so it should start at 0.
+template <typename T>
+inline CLI_Interface * Parser::count(T& var, std::vector<const char *> flags, const char * help_message) {
+	return add_option<Count<T>>(var, std::move(flags), help_message);
+}
+
+// Adds every value of the option to var.
+template <typename T>
+inline CLI_Interface * Parser::sum(T& var, std::vector<const char *> flags, const char * help_message) {
+	return add_option<Sum<T>>(var, std::move(flags), help_message);
+}
+
+// ORs the mask of every flag given into word. The names are the aliases of a
+// single option, so help_message describes them all.
+template <typename T>
+inline CLI_Interface * Parser::bits(T& word, std::vector<std::pair<const char *, T>> bits, const char * help_message) {
+	return add_option<Bits<T>>(word, std::move(bits), help_message);
+}
+
+#ifdef CPP_CLI_DEFINITIONS
+#ifdef CPP_CLI_PMR
+CPP_CLI_INLINE Parser::Parser(cli_memory_resource * r) :
+	resource(r),
+	command_line_settings_map(r),
+	list_of_cmd_var(r),
+	non_options(r),
+	subcommand_map(r),
+	subcommand_list(r),
+	subcommand_aliases(r),
+	subcommand_help_names(r),
+	subcommand_descriptions(r),
+	commands(r),
+	command_table(r),
+	action_table(r),
+	inherited_options(r),
+	global_options(r),
+	option_memory(r),
+	deferred_values(r),
+	option_records(r),
+	seen_options(r),
+	constraints(r),
+	constraint_members(r),
+	constraint_masks(r),
+	interned_strings(r),
+	arg_tokens(r) {}
+#endif
+
+CPP_CLI_INLINE Parser::~Parser() {
+	clear_selected_command();
 	clear_managed_vars();
 }
 
+// Shared by every Parser on a thread so that subcommands keep the help settings
+// of their supercommands. It is a function local static so that nothing is
+// constructed before main, and one per thread so that parse_batch can build
+// commands on several threads at once.
+CPP_CLI_INLINE CLI_Help& Parser::help_manager() {
+	static thread_local CLI_Help help_manager;
+	return help_manager;
+}
+
+// The result parse_levels is filling on this thread, if any, so that the
+// parsers of nested subcommands can add their levels to it.
+CPP_CLI_INLINE Parse_Result *& Parser::active_result() {
+	static thread_local Parse_Result * active_result = nullptr;
+	return active_result;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 //////////////////////////////INLINE DECLARATIONS//////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-inline std::vector<const char *> Parser::parse(int argc, char ** argv, void * data) {
-	fill_hash_table();
-	fill_subcommand_hash_table();
-	non_options.reserve(2 * argc);
-	int i = 1;
-	for (; i < argc; i++) {
-		// case: subcommand, which is recursive
-		if (subcommand_map.count(argv[i]) != 0) {
-			subcommand_handling(argc - i, argv + i, data);
+// Neither the arguments nor the array holding them are written to, so argv may
+// point into read-only memory or be shared with other threads, which may
+// parse it at the same time with parsers of their own. A subcommand function
+// gets the rest of argv as a char ** all the same, and must not pass it on to
+// parse_levels, which reorders it, unless argv is writable.
+CPP_CLI_INLINE std::vector<const char *> Parser::parse(int argc, const char * const * argv, void * data) {
+	Parse_Error parse_error = try_parse(argc, argv, data);
+	if (parse_error) {
+		raise_error<std::invalid_argument>(parse_error.message());
+	}
+	// The result belongs to the caller, so it comes from the global allocator.
+	// parse_levels returns views that need no memory of their own.
+#ifdef CPP_CLI_PMR
+	return std::vector<const char *>(non_options.begin(), non_options.end());
+#else
+	return non_options;
+#endif
+}
+
+// Like parse, except that errors in the command line are returned instead of
+// thrown, and the non-options are left in get_non_options. Nothing is
+// formatted or allocated for an error, and the selected command only runs if
+// there was none. Errors raised while converting a value, such as by a
+// Vector<char *>, are still thrown.
+CPP_CLI_INLINE Parse_Error Parser::try_parse(int argc, const char * const * argv, void * data) {
+	parse_arguments(argc, argv, data);
+	if (!error && action_option == nullptr) {
+		run_selected_command(data);
+	}
+	// Inside parse_levels the non-options are already in order at argv[1]
+	// onwards.
+	if (filling != nullptr) {
+		non_options.assign(argv + 1, argv + level_write);
+		filling = nullptr;
+	}
+	return error;
+}
+
+CPP_CLI_INLINE const cli_vector<const char *>& Parser::get_non_options() const {
+	return non_options;
+}
+
+// Like parse, except that nothing is collected. The non-options of every
+// command level are moved in place to the front of that level's arguments,
+// so argv is reordered the same way getopt does it, and the result holds
+// views into argv. A subcommand adds its level to the same result the first
+// time it calls parse.
+CPP_CLI_INLINE Parse_Result Parser::parse_levels(int argc, char ** argv, void * data) {
+	Parse_Result result(resource);
+	result.levels.push_back({ argv[0], Arg_Span(), Arg_Span() });
+	result.pending_level = 0;
+	Parse_Result * previous = active_result();
+	active_result() = &result;
+	CLI_TRY {
+		parse_arguments(argc, argv, data);
+		if (error) {
+			raise_error<std::invalid_argument>(error.message());
+		}
+		if (action_option == nullptr) {
+			run_selected_command(data);
+		}
+	} CLI_CATCH_ALL {
+		active_result() = previous;
+		filling = nullptr;
+		CLI_RETHROW;
+	}
+	active_result() = previous;
+	filling = nullptr;
+	return result;
+}
+
+CPP_CLI_INLINE void Parser::parse_arguments(int argc, const char * const * argv, void * data) {
+	error = Parse_Error();
+	options_indexed = false;
+	subcommands_indexed = false;
+	action_option = nullptr;
+	non_options.clear();
+	clear_selected_command();
+	reset_option_records();
+	current_source = Option_Source::command_line;
+	argv_offset = 0;
+
+	Parse_Result * result = active_result();
+	if (result != nullptr && result->pending_level != Parse_Result::no_level) {
+		filling = result;
+		level_index = result->pending_level;
+		result->pending_level = Parse_Result::no_level;
+		level_argv = const_cast<char **>(argv);
+		level_write = 1;
+		level_dash_dash = -1;
+	} else {
+		filling = nullptr;
+		non_options.reserve(2 * argc);
+	}
+
+	arg_tokens.resize(argc);
+	classify_arguments(argc, argv, arg_tokens.data());
+	for (int i = 1; i < argc && !error && action_option == nullptr; i++) {
+		if (parse_argument(argc, argv, arg_tokens.data(), i, data)) {
 			break;
 		}
-		// cases: --long-option
-		else if (argv[i][2] != '\0' && argv[i][1] == '-' && argv[i][0] == '-') {
-			long_option_handling(argv, i);
-		// case: -- and all arguments are options
-		} else if (argv[i][0] == '-' && argv[i][1] == '-' && argv[i][2] == '\0') {
-			i++;
-			for (; i < argc; i++) {
-				non_options.push_back(argv[i]);
+	}
+	finish_parsing();
+	if (filling != nullptr) {
+		finish_level();
+	}
+}
+
+// Handles argv[i], moving i past any argument it consumes. Returns true if the
+// rest of the command line has been handled as well. tokens[i] classifies
+// argv[i].
+CPP_CLI_INLINE bool Parser::parse_argument(int argc, const char * const * argv, const Arg_Token * tokens, int& i, void * data) {
+	const Arg_Token& token = tokens[i];
+	const Command * command = nullptr;
+	CLI_Interface * action = nullptr;
+	// case: action, which needs nothing else to be set up
+	if (action_table.size() != 0 && (action = find_action(argv[i], token)) != nullptr) {
+		set_option(action, argv[i], i);
+		return true;
+	}
+	// case: subcommand, which is recursive
+	else if (!subcommand_aliases.empty() && find_subcommand(Arg_View(argv[i], token.length)) != nullptr) {
+		subcommand_handling(argc - i, argv + i, data);
+		return true;
+	}
+	// case: command, whose parser carries on from here, except in a stream
+	else if (token.kind == Arg_Kind::non_option && !commands.empty() && non_option_sink == nullptr && (command = find_command(Arg_View(argv[i], token.length))) != nullptr) {
+		command_handling(command, argc - i, argv + i, tokens + i, data, i);
+		return true;
+	}
+	// cases: --long-option
+	else if (token.kind == Arg_Kind::long_option) {
+		long_option_handling(argv, token, i);
+	// case: -- and all arguments are options
+	} else if (token.kind == Arg_Kind::dash_dash) {
+		level_dash_dash = level_write;
+		i++;
+		for (; i < argc; i++) {
+			add_non_option(argv[i]);
+		}
+		return true;
+	// case: -
+	} else if (token.kind == Arg_Kind::dash && find_option("-") != nullptr) {
+		set_option(find_option("-"), "-", i);
+	} else if (token.kind != Arg_Kind::non_option) {
+		short_option_handling(argc, argv, token, i);
+	} else {
+		add_non_option(argv[i]);
+	}
+	return false;
+}
+
+CPP_CLI_INLINE void Parser::add_non_option(const char * arg) {
+	if (non_option_sink != nullptr) {
+		non_option_sink(arg, non_option_sink_data);
+	} else if (filling != nullptr) {
+		// Every argument before this one has been handled, so the slot being
+		// written to is free.
+		level_argv[level_write++] = const_cast<char *>(arg);
+	} else {
+		non_options.push_back(arg);
+	}
+}
+
+// Reads arguments separated by delimiter from fd and parses them with the same
+// rules as parse, buffer_size bytes at a time. Non-options are handed to sink
+// as they are found instead of being collected, so memory use does not depend
+// on the number of arguments. Arguments only live until the buffer is
+// refilled, so anything bound to an option has to copy its value, e.g. a
+// std::string or a Sink, rather than keep the pointer like a const char *.
+// Empty arguments are skipped, and subcommands and commands are not
+// recognized, so their names go to sink like any other non-option. An option
+// and the argument after it have to fit in the buffer together.
+CPP_CLI_INLINE void Parser::parse_stream(int fd, argument_sink sink, void * sink_data, char delimiter, size_t buffer_size) {
+	error = Parse_Error();
+	options_indexed = false;
+	// Subcommands are not recognized in a stream, and neither are commands,
+	// which parse_argument checks for itself.
+	subcommand_map.clear();
+	subcommands_indexed = true;
+	action_option = nullptr;
+	non_options.clear();
+	reset_option_records();
+	current_source = Option_Source::stream;
+	non_option_sink = sink;
+	non_option_sink_data = sink_data;
+
+	cli_vector<char> buffer = make_container<cli_vector<char>>(resource);
+	buffer.resize(buffer_size + 1);
+	char * buf = buffer.data();
+	cli_vector<char *> tokens = make_container<cli_vector<char *>>(resource);
+	tokens.reserve(buffer_size / 2 + 2);
+	size_t token_start = 0;
+	size_t end = 0;
+	// The position in the stream of tokens[0].
+	int stream_position = 0;
+	bool only_non_options = false;
+	// Set once an argument has handled the rest of the stream, as an action
+	// does.
+	bool stopped = false;
+	bool eof = false;
+	CLI_TRY {
+		if (error) {
+			raise_error<std::invalid_argument>(error.message());
+		}
+		while (!eof && !stopped) {
+			if (end == buffer_size) {
+				raise_error<std::runtime_error>("An argument from the stream does not fit in the stream buffer.");
 			}
-			break;
-		// case: -
-		} else if (argv[i][0] == '-' && argv[i][1] == '\0' && command_line_settings_map.count("-") != 0) {
-			command_line_settings_map["-"]->set_base_variable("-");
-		} else if (argv[i][0] == '-') {
-			short_option_handling(argc, argv, i);
-		} else {
-			non_options.push_back(argv[i]);
+			ssize_t bytes_read = read(fd, buf + end, buffer_size - end);
+			if (bytes_read < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				raise_error<std::runtime_error>("Could not read arguments from the stream.");
+			}
+			eof = bytes_read == 0;
+			for (size_t j = end; j < end + bytes_read; j++) {
+				if (buf[j] == delimiter) {
+					buf[j] = '\0';
+					if (j != token_start) {
+						tokens.push_back(buf + token_start);
+					}
+					token_start = j + 1;
+				}
+			}
+			end += bytes_read;
+			if (eof && token_start < end) {
+				buf[end] = '\0';
+				tokens.push_back(buf + token_start);
+				token_start = end;
+			}
+
+			// An option may take the next argument, so an argument is only
+			// handled once the one after it is complete or there are no more.
+			size_t k = 0;
+			while (k < tokens.size() && (eof || k + 1 < tokens.size()) && !stopped) {
+				if (only_non_options) {
+					add_non_option(tokens[k]);
+				} else if (strcmp(tokens[k], "--") == 0) {
+					only_non_options = true;
+				} else {
+					int i = 0;
+					int window = k + 1 < tokens.size() ? 2 : 1;
+					Arg_Token window_tokens[2];
+					classify_arguments(window, tokens.data() + k, window_tokens);
+					argv_offset = stream_position + (int)k;
+					stopped = parse_argument(window, tokens.data() + k, window_tokens, i, nullptr);
+					if (error) {
+						raise_error<std::invalid_argument>(error.message());
+					}
+					k += i;
+				}
+				k++;
+			}
+
+			// Move whatever has not been handled to the front of the buffer.
+			char * keep = k < tokens.size() ? tokens[k] : buf + token_start;
+			size_t offset = keep - buf;
+			memmove(buf, keep, end - offset);
+			for (size_t j = k; j < tokens.size(); j++) {
+				tokens[j - k] = tokens[j] - offset;
+			}
+			tokens.resize(tokens.size() - k);
+			stream_position += (int)k;
+			token_start -= offset;
+			end -= offset;
+		}
+		argv_offset = 0;
+		finish_parsing();
+		if (error) {
+			raise_error<std::invalid_argument>(error.message());
 		}
+	} CLI_CATCH_ALL {
+		non_option_sink = nullptr;
+		current_source = Option_Source::command_line;
+		argv_offset = 0;
+		CLI_RETHROW;
 	}
-	return non_options;
+	non_option_sink = nullptr;
+	current_source = Option_Source::command_line;
+	argv_offset = 0;
+}
+
+// A snapshot image starts with a magic number, a hash of the options it was
+// saved from and the number of options. Then comes where the saved value of
+// each option ends, relative to the first value, followed by the values in
+// the order the options were added.
+static const char snapshot_magic[8] = { 'c', 'p', 'p', '_', 'c', 'l', 'i', '1' };
+static const size_t snapshot_header_size = sizeof(snapshot_magic) + 2 * sizeof(uint64_t);
+
+// Saves the variables bound to the options of this parser into image and
+// returns the size of the image. If image is null, only the size is returned.
+// The image holds no pointers, so it can be written to a file or to shared
+// memory and loaded by another process that adds the same options in the
+// same order. Options that cannot be saved, such as a Sink, are left out, and
+// so are the options of commands.
+CPP_CLI_INLINE size_t Parser::save_snapshot(char * image) {
+	const size_t num_options = list_of_cmd_var.size();
+	const size_t values_start = snapshot_header_size + num_options * sizeof(uint64_t);
+	size_t end = values_start;
+	for (size_t i = 0; i < num_options; i++) {
+		CLI_Interface * option = list_of_cmd_var[i];
+		if (!option->ignored()) {
+			end += option->write_snapshot(image == nullptr ? nullptr : image + end);
+		}
+		if (image != nullptr) {
+			write_snapshot_length(end - values_start, image + snapshot_header_size + i * sizeof(uint64_t));
+		}
+	}
+	if (image != nullptr) {
+		memcpy(image, snapshot_magic, sizeof(snapshot_magic));
+		write_snapshot_length(schema_hash(), image + sizeof(snapshot_magic));
+		write_snapshot_length(num_options, image + sizeof(snapshot_magic) + sizeof(uint64_t));
+	}
+	return end;
+}
+
+// Sets the variables bound to the options of this parser from an image made
+// by save_snapshot, in place of parsing. Nothing is tokenized or converted
+// again, and values saved as const char * or Arg_View point into the image.
+// Returns false, possibly after setting some of the variables, if the image
+// was saved from different options or is malformed.
+CPP_CLI_INLINE bool Parser::load_snapshot(const char * image, size_t size) {
+	const size_t num_options = list_of_cmd_var.size();
+	uint64_t hash;
+	uint64_t saved_options;
+	if (size < snapshot_header_size || memcmp(image, snapshot_magic, sizeof(snapshot_magic)) != 0) {
+		return false;
+	}
+	read_snapshot_length(hash, image + sizeof(snapshot_magic), sizeof(uint64_t));
+	read_snapshot_length(saved_options, image + sizeof(snapshot_magic) + sizeof(uint64_t), sizeof(uint64_t));
+	if (hash != schema_hash() || saved_options != num_options || (size - snapshot_header_size) / sizeof(uint64_t) < num_options) {
+		return false;
+	}
+	const size_t values_start = snapshot_header_size + num_options * sizeof(uint64_t);
+	uint64_t begin = 0;
+	for (size_t i = 0; i < num_options; i++) {
+		uint64_t end;
+		read_snapshot_length(end, image + snapshot_header_size + i * sizeof(uint64_t), sizeof(uint64_t));
+		if (end < begin || end > size - values_start) {
+			return false;
+		}
+		if (end != begin && !list_of_cmd_var[i]->read_snapshot(image + values_start + begin, end - begin)) {
+			return false;
+		}
+		begin = end;
+	}
+	return true;
+}
+
+// Saves a snapshot, built in a single buffer, to fd. Load it with
+// Mapped_Snapshot and load_snapshot.
+CPP_CLI_INLINE void Parser::write_snapshot(int fd) {
+	cli_vector<char> image = make_container<cli_vector<char>>(resource);
+	image.resize(save_snapshot(nullptr));
+	save_snapshot(image.data());
+	size_t written = 0;
+	while (written < image.size()) {
+		ssize_t bytes_written = write(fd, image.data() + written, image.size() - written);
+		if (bytes_written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			raise_error<std::runtime_error>("Could not write the snapshot.");
+		}
+		written += bytes_written;
+	}
+}
+
+// FNV-1a over the aliases of every option and whether it takes arguments, so
+// that an image is not loaded into options it was not saved from.
+CPP_CLI_INLINE uint64_t Parser::schema_hash() const {
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < list_of_cmd_var.size(); i++) {
+		const std::vector<const char *>& aliases = list_of_cmd_var[i]->get_aliases();
+		hash = (hash ^ (unsigned char)list_of_cmd_var[i]->takes_args()) * 1099511628211ULL;
+		for (size_t j = 0; j < aliases.size(); j++) {
+			for (const char * c = aliases[j]; ; c++) {
+				hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+				if (*c == '\0') {
+					break;
+				}
+			}
+		}
+		hash = (hash ^ 0xff) * 1099511628211ULL;
+	}
+	return hash;
 }
 
-inline void Parser::fill_hash_table() {
-	command_line_settings_map = std::unordered_map<std::string, CLI_Interface *>(num_unique_flags);
-	std::unordered_map<std::string, int *> flag_already_used(num_unique_flags);
-	for (size_t i = 0; i < Parser::list_of_cmd_var.size(); i++) {
-		CLI_Interface * cur_com_var = list_of_cmd_var[i];
+// Builds an argv that sets the variables bound to the options of this parser
+// to their current values, for starting another process with execve. Options
+// are written in the order they were added, in a canonical form, and only if
+// filter, when given, returns true for them. The positionals, if any, come
+// after a "--". Everything is built in a single allocation.
+CPP_CLI_INLINE Argv_Buffer Parser::make_argv(const char * program, option_filter filter, void * filter_data, const char * const * positionals, size_t num_positionals) const {
+	Argv_Writer measure;
+	write_argv(measure, program, filter, filter_data, positionals, num_positionals);
+	const size_t pointer_size = (measure.arguments() + 1) * sizeof(char *);
+	char * memory = new char[pointer_size + measure.size()];
+	Argv_Writer writer((char **)memory, memory + pointer_size);
+	write_argv(writer, program, filter, filter_data, positionals, num_positionals);
+	((char **)memory)[writer.arguments()] = nullptr;
+	return Argv_Buffer(memory, (int)writer.arguments());
+}
+
+CPP_CLI_INLINE void Parser::write_argv(Argv_Writer& writer, const char * program, option_filter filter, void * filter_data, const char * const * positionals, size_t num_positionals) const {
+	writer.argument(Arg_View(program));
+	for (size_t i = 0; i < list_of_cmd_var.size(); i++) {
+		const CLI_Interface * option = list_of_cmd_var[i];
+		if (!option->ignored() && (filter == nullptr || filter(option, filter_data))) {
+			option->write_arguments(writer);
+		}
+	}
+	if (num_positionals != 0) {
+		writer.argument(Arg_View("--", 2));
+		for (size_t i = 0; i < num_positionals; i++) {
+			writer.argument(Arg_View(positionals[i]));
+		}
+	}
+}
+
+CPP_CLI_INLINE void Parser::fill_hash_table() {
+	options_indexed = true;
+	command_line_settings_map.clear();
+	command_line_settings_map.reserve(num_unique_flags);
+	for (size_t i = 0; i < list_of_cmd_var.size() + inherited_options.size(); i++) {
+		CLI_Interface * cur_com_var = i < list_of_cmd_var.size() ? list_of_cmd_var[i] : inherited_options[i - list_of_cmd_var.size()];
 		const std::vector<const char *> & cur_aliases = cur_com_var->get_aliases();
 		for (size_t j = 0; j < cur_aliases.size(); j++) {
-			check_if_option_exists("Flag already used: ", cur_aliases[j], flag_already_used.count(cur_aliases[j]), false);
-			flag_already_used.insert({cur_aliases[j], nullptr});
-			command_line_settings_map.insert({cur_aliases[j], cur_com_var});
+			if (!command_line_settings_map.emplace(cur_aliases[j], cur_com_var).second) {
+				fail(Parse_Error_Code::flag_already_used, -1, Arg_View(cur_aliases[j]), "");
+				return;
+			}
+		}
+	}
+}
+
+CPP_CLI_INLINE void Parser::set_option(CLI_Interface * option, const char * value, int index) {
+	record_option(option, index);
+	if (take_action(option)) {
+		return;
+	}
+	if (deferred_converter != nullptr && option->takes_args() && option->converts_in_parallel()) {
+		deferred_values.push_back({ option, value, index });
+	} else if (!option->try_set_base_variable(value)) {
+		fail(Parse_Error_Code::invalid_value, index, Arg_View(value), "", option);
+	}
+}
+
+// Only a whole "-x" or "--name" can be an action, since an action takes no
+// arguments and "-vx" is handled with the other short options.
+CPP_CLI_INLINE CLI_Interface * Parser::find_action(const char * arg, const Arg_Token& token) {
+	CLI_Interface * const * action = nullptr;
+	if (token.kind == Arg_Kind::short_option && token.length == 2) {
+		action = action_table.find(Arg_View(arg + 1, 1));
+	} else if (token.kind == Arg_Kind::long_option && token.split == token.length) {
+		action = action_table.find(Arg_View(arg + 2, token.length - 2));
+	}
+	return action == nullptr ? nullptr : *action;
+}
+
+// Runs option if it is an action, which ends parsing.
+CPP_CLI_INLINE bool Parser::take_action(CLI_Interface * option) {
+	if (!option->run_action(*this)) {
+		return false;
+	}
+	action_option = option;
+	return true;
+}
+
+// What is left once the arguments have been handled, none of which is done if
+// an action ended parsing. The tables are filled even if nothing was looked
+// up, so that a flag added twice is still reported.
+CPP_CLI_INLINE void Parser::finish_parsing() {
+	if (action_option != nullptr) {
+		return;
+	}
+	if (!options_indexed) {
+		fill_hash_table();
+	}
+	if (!subcommands_indexed) {
+		fill_subcommand_hash_table();
+	}
+	if (!error) {
+		check_constraints();
+	}
+	write_pending_help();
+}
+
+// Records that the argument at index set option, in the parser the option was
+// added to, which is a supercommand's for an inherited global option.
+CPP_CLI_INLINE void Parser::record_option(CLI_Interface * option, int index) {
+	Parser * owner = option->owner;
+	uint32_t i = option->option_index;
+	if (owner == nullptr || i >= owner->option_records.size()) {
+		return;
+	}
+	owner->option_records[i] = { index < 0 ? -1 : argv_offset + index, current_source };
+	owner->seen_options[i / 64] |= (uint64_t)1 << (i % 64);
+}
+
+CPP_CLI_INLINE void Parser::reset_option_records() {
+	option_records.assign(list_of_cmd_var.size(), Option_Record{ -1, Option_Source::unset });
+	seen_options.assign((list_of_cmd_var.size() + 63) / 64, 0);
+}
+
+CPP_CLI_INLINE uint32_t Parser::constrained_option(const CLI_Interface * option) const {
+	if (option == nullptr || option->owner != this) {
+		raise_error<std::invalid_argument>("Constraints can only name options added to the parser they are declared on.");
+	}
+	return option->option_index;
+}
+
+CPP_CLI_INLINE void Parser::add_constraint(Option_Constraint::Kind kind, uint32_t subject, const std::vector<CLI_Interface *>& members) {
+	// Every member is checked first, so that a rejected constraint leaves
+	// nothing behind.
+	for (size_t i = 0; i < members.size(); i++) {
+		constrained_option(members[i]);
+	}
+	constraints.push_back({ kind, subject, constraint_members.size(), members.size() });
+	for (size_t i = 0; i < members.size(); i++) {
+		constraint_members.push_back(members[i]->option_index);
+	}
+	constraint_masks_options = (size_t)-1;
+}
+
+CPP_CLI_INLINE void Parser::compile_constraints() {
+	size_t words = seen_options.size();
+	constraint_masks.assign(constraints.size() * words, 0);
+	for (size_t c = 0; c < constraints.size(); c++) {
+		uint64_t * mask = constraint_masks.data() + c * words;
+		for (size_t m = 0; m < constraints[c].num_members; m++) {
+			uint32_t i = constraint_members[constraints[c].first_member + m];
+			mask[i / 64] |= (uint64_t)1 << (i % 64);
+		}
+	}
+	constraint_masks_options = list_of_cmd_var.size();
+}
+
+// The argv index option was last seen at, relative to the argv this parser
+// was given, like the index of any other error.
+CPP_CLI_INLINE int Parser::relative_index(uint32_t option) const {
+	int index = option_records[option].index;
+	return index < 0 ? -1 : index - argv_offset;
+}
+
+// Every constraint is checked with a few operations per word of the seen
+// options, so the cost does not depend on the number of arguments. The
+// members are only looked at one by one to report a broken constraint.
+CPP_CLI_INLINE void Parser::check_constraints() {
+	if (constraints.empty()) {
+		return;
+	}
+	if (constraint_masks_options != list_of_cmd_var.size()) {
+		compile_constraints();
+	}
+	size_t words = seen_options.size();
+	for (size_t c = 0; c < constraints.size() && !error; c++) {
+		const Option_Constraint& constraint = constraints[c];
+		const uint64_t * mask = constraint_masks.data() + c * words;
+		const uint32_t * members = constraint_members.data() + constraint.first_member;
+		if (constraint.kind == Option_Constraint::exclusive) {
+			bool several = false;
+			bool any = false;
+			for (size_t w = 0; w < words; w++) {
+				uint64_t both = seen_options[w] & mask[w];
+				several = several || (both & (both - 1)) != 0 || (both != 0 && any);
+				any = any || both != 0;
+			}
+			if (!several) {
+				continue;
+			}
+			uint32_t first = (uint32_t)-1;
+			for (size_t m = 0; m < constraint.num_members; m++) {
+				uint32_t i = members[m];
+				if ((seen_options[i / 64] >> (i % 64) & 1) == 0 || i == first) {
+					continue;
+				}
+				if (first == (uint32_t)-1) {
+					first = i;
+				} else {
+					int index = std::max(relative_index(first), relative_index(i));
+					fail(Parse_Error_Code::exclusive_options, index, Arg_View(), "", list_of_cmd_var[first], list_of_cmd_var[i]);
+					break;
+				}
+			}
+			continue;
+		}
+		if (constraint.kind == Option_Constraint::dependency && (seen_options[constraint.subject / 64] >> (constraint.subject % 64) & 1) == 0) {
+			continue;
+		}
+		bool complete = true;
+		for (size_t w = 0; w < words; w++) {
+			complete = complete && (seen_options[w] & mask[w]) == mask[w];
+		}
+		if (complete) {
+			continue;
+		}
+		for (size_t m = 0; m < constraint.num_members; m++) {
+			uint32_t i = members[m];
+			if ((seen_options[i / 64] >> (i % 64) & 1) != 0) {
+				continue;
+			}
+			if (constraint.kind == Option_Constraint::required) {
+				fail(Parse_Error_Code::missing_required_option, -1, Arg_View(), "", list_of_cmd_var[i]);
+			} else {
+				fail(Parse_Error_Code::missing_dependency, relative_index(constraint.subject), Arg_View(), "", list_of_cmd_var[constraint.subject], list_of_cmd_var[i]);
+			}
+			break;
+		}
+	}
+}
+
+// Subcommand functions take a char ** so that existing ones keep working, but
+// it is argv with its const cast away. Writing to it, which parse_levels does,
+// is only safe if the caller of parse passed a writable array, as callers of
+// parse_levels always do.
+CPP_CLI_INLINE void Parser::subcommand_handling(int argc, const char * const * argv, void * data) {
+	// The subcommand may read anything set before it, so deferred values have
+	// to be converted first.
+	if (deferred_converter != nullptr) {
+		deferred_converter(*this);
+	}
+	subcommand_func sub_com = find_subcommand(Arg_View(argv[0]));
+	char ** sub_argv = const_cast<char **>(argv);
+	if (filling == nullptr) {
+		non_options.push_back(nullptr);
+		non_options.push_back(argv[0]);
+		sub_com(argc, sub_argv, data);
+		return;
+	}
+	finish_level();
+	filling->levels.push_back({ argv[0], Arg_Span(), Arg_Span() });
+	filling->pending_level = filling->levels.size() - 1;
+	CLI_TRY {
+		sub_com(argc, sub_argv, data);
+	} CLI_CATCH_ALL {
+		filling->pending_level = Parse_Result::no_level;
+		CLI_RETHROW;
+	}
+	// Only the first parse in the subcommand fills its level.
+	filling->pending_level = Parse_Result::no_level;
+}
+
+CPP_CLI_INLINE void Parser::finish_level() {
+	int dash_dash = level_dash_dash < 0 ? level_write : level_dash_dash;
+	Command_Level& level = filling->levels[level_index];
+	level.positionals = Arg_Span(level_argv + 1, dash_dash - 1);
+	level.after_dash_dash = Arg_Span(level_argv + dash_dash, level_write - dash_dash);
+}
+
+CPP_CLI_INLINE const Command * Parser::find_command(Arg_View name) {
+	const size_t * index = command_table.find(name);
+	return index == nullptr ? nullptr : &commands[*index];
+}
+
+// Builds the schema of the selected command and parses the rest of the command
+// line with it, so every argument is still only looked at once. Non-options
+// after the command are added after a nullptr and the command's name, just
+// like with subcommands, or to a level of their own in parse_levels. offset is
+// where argv starts in the argv of this parser, so that the index of an error
+// in the command's arguments can be reported relative to it, and tokens
+// classifies argv.
+CPP_CLI_INLINE void Parser::command_handling(const Command * command, int argc, const char * const * argv, const Arg_Token * tokens, void * data, int offset) {
+	if (deferred_converter != nullptr) {
+		deferred_converter(*this);
+	}
+	selected_command = command;
+#ifdef CPP_CLI_PMR
+	selected_parser = cli_new<Parser>(resource, resource);
+#else
+	selected_parser = cli_new<Parser>(resource);
+#endif
+	selected_parser->inherited_options = global_options;
+	selected_parser->global_options = global_options;
+	command->build(*selected_parser, data);
+	selected_parser->reset_option_records();
+	selected_parser->current_source = current_source;
+	selected_parser->argv_offset = argv_offset + offset;
+
+	if (filling != nullptr) {
+		finish_level();
+		filling->levels.push_back({ argv[0], Arg_Span(), Arg_Span() });
+		selected_parser->filling = filling;
+		selected_parser->level_index = filling->levels.size() - 1;
+		selected_parser->level_argv = const_cast<char **>(argv);
+		selected_parser->level_write = 1;
+		selected_parser->level_dash_dash = -1;
+	} else {
+		non_options.push_back(nullptr);
+		non_options.push_back(argv[0]);
+	}
+	for (int i = 1; i < argc && !selected_parser->error && selected_parser->action_option == nullptr; i++) {
+		if (selected_parser->parse_argument(argc, argv, tokens, i, data)) {
+			break;
 		}
 	}
+	selected_parser->finish_parsing();
+	action_option = selected_parser->action_option;
+	if (selected_parser->error) {
+		error = selected_parser->error;
+		if (error.index >= 0) {
+			error.index += offset;
+		}
+	}
+	if (filling != nullptr) {
+		selected_parser->finish_level();
+		selected_parser->filling = nullptr;
+	} else {
+		non_options.insert(non_options.end(), selected_parser->non_options.begin(), selected_parser->non_options.end());
+	}
+}
+
+// Only the innermost selected command runs, the same way "git remote add"
+// runs add and not remote.
+CPP_CLI_INLINE void Parser::run_selected_command(void * data) {
+	Parser * innermost = this;
+	while (innermost->selected_parser != nullptr && innermost->selected_parser->selected_parser != nullptr) {
+		innermost = innermost->selected_parser;
+	}
+	if (innermost->selected_command != nullptr && innermost->selected_command->run != nullptr) {
+		innermost->selected_command->run(*innermost->selected_parser, data);
+	}
 }
 
-inline void Parser::subcommand_handling(int argc, char ** argv, void * data) {
-	subcommand_func sub_com = *(subcommand_map[argv[0]]);
-	non_options.push_back(nullptr);
-	non_options.push_back(argv[0]);
-	help_manager.subcommand_descriptions.clear();
-	sub_com(argc, argv, data);
+CPP_CLI_INLINE void Parser::clear_selected_command() {
+	cli_delete(resource, selected_parser);
+	selected_parser = nullptr;
+	selected_command = nullptr;
 }
 
-inline void Parser::reserve_space_for_subcommand(size_t number_of_subcommand) {
+CPP_CLI_INLINE void Parser::reserve_space_for_subcommand(size_t number_of_subcommand) {
 	subcommand_list.reserve(number_of_subcommand);
 	subcommand_aliases.reserve(number_of_subcommand);
 }
 
-inline void Parser::add_subcommand(const char * subcommand, Parser::subcommand_func sub_func, const char * description) {
+CPP_CLI_INLINE void Parser::add_subcommand(const char * subcommand, Parser::subcommand_func sub_func, const char * description) {
 	subcommand_list.push_back(sub_func);
 	subcommand_aliases.push_back(subcommand);
-	help_manager.subcommand_descriptions.push_back(description);
+	subcommand_help_names.push_back(subcommand);
+	subcommand_descriptions.push_back(description);
+}
+
+// Declares a command whose options are only registered, by build, if it is
+// selected, so a program with many commands only pays for the one it runs.
+CPP_CLI_INLINE void Parser::add_command(const char * name, command_func build, command_func run, const char * description) {
+	command_table.insert(Arg_View(name), commands.size());
+	commands.push_back({ name, build, run });
+	subcommand_help_names.push_back(name);
+	subcommand_descriptions.push_back(description);
+}
+
+// Makes option accepted by every command selected below this parser as well.
+CPP_CLI_INLINE CLI_Interface * Parser::global(CLI_Interface * option) {
+	global_options.push_back(option);
+	return option;
 }
 
-inline void Parser::fill_subcommand_hash_table() {
+CPP_CLI_INLINE Parser::subcommand_func Parser::find_subcommand(Arg_View name) {
+	if (!subcommands_indexed) {
+		fill_subcommand_hash_table();
+	}
+	cli_hash_map<Arg_View, subcommand_func, Arg_View_Hash>::const_iterator it = subcommand_map.find(name);
+	return it == subcommand_map.end() ? nullptr : it->second;
+}
+
+CPP_CLI_INLINE void Parser::fill_subcommand_hash_table() {
+	subcommands_indexed = true;
 	size_t n_sub = subcommand_aliases.size();
+	subcommand_map.clear();
 	subcommand_map.reserve(2 * n_sub);
-	std::unordered_map<std::string, int *> flag_already_used(2 * n_sub);
 	for (size_t i = 0; i < n_sub; i++) {
-		check_if_option_exists("Subcommand already used: ", subcommand_aliases[i], flag_already_used.count(subcommand_aliases[i]), false);
-		flag_already_used.insert({subcommand_aliases[i], nullptr});
-		subcommand_map.insert({subcommand_aliases[i], subcommand_list[i]});
+		if (!subcommand_map.emplace(subcommand_aliases[i], subcommand_list[i]).second) {
+			fail(Parse_Error_Code::subcommand_already_used, -1, Arg_View(subcommand_aliases[i]), "");
+			return;
+		}
 	}
 }
 
-void Parser::clear_managed_vars() {
+CPP_CLI_INLINE void Parser::clear_managed_vars() {
 	for (size_t i = 0; i < list_of_cmd_var.size(); i++) {
+#ifdef CPP_CLI_PMR
+		list_of_cmd_var[i]->~CLI_Interface();
+		resource->deallocate(option_memory[i].memory, option_memory[i].size, option_memory[i].alignment);
+#else
 		delete list_of_cmd_var[i];
+#endif
+	}
+	if (state_deleter != nullptr) {
+		state_deleter(resource, state);
 	}
 }
 
-inline int Parser::find_and_mark_split_location(char * flag) {
-	int split_location = 0;
-	for (; flag[split_location] != '\0'; split_location++) {
-		if (flag[split_location] == '=') {
-			flag[split_location] = '\0';
-			split_location++;
-			break;
-		}
+CPP_CLI_INLINE CLI_Interface * Parser::find_option(Arg_View alias) {
+	if (!options_indexed) {
+		fill_hash_table();
 	}
-	return split_location;
+	cli_hash_map<Arg_View, CLI_Interface *, Arg_View_Hash>::const_iterator it = command_line_settings_map.find(alias);
+	return it == command_line_settings_map.end() ? nullptr : it->second;
 }
 
-inline void Parser::check_if_option_exists(const char * error_message, const char * potential_option, const bool exists, const bool should_exist) {
-	if (exists != should_exist) {
-		std::string error_message_buffer;
-		error_message_buffer.reserve(1024);
-		error_message_buffer += error_message;
-		error_message_buffer += potential_option;
-		throw std::invalid_argument(error_message_buffer);
+// Only the first error is kept, since later ones are usually caused by it.
+CPP_CLI_INLINE void Parser::fail(Parse_Error_Code code, int index, Arg_View token, const char * flag_prefix, const CLI_Interface * option, const CLI_Interface * other_option) {
+	if (error) {
+		return;
 	}
+	error.code = code;
+	error.index = index;
+	error.token = token;
+	error.flag_prefix = flag_prefix;
+	error.option = option;
+	error.other_option = other_option;
 }
 
-inline void Parser::long_option_handling(char ** argv, int& i) {
-	char * temp_alias = argv[i] + 2;
-	int split_location = find_and_mark_split_location(temp_alias);
+// The alias ends at the '=' the token found, so it is looked up as a view and
+// argv is never written to.
+CPP_CLI_INLINE void Parser::long_option_handling(const char * const * argv, const Arg_Token& token, int& i) {
+	const char * temp_alias = argv[i] + 2;
+	Arg_View alias(temp_alias, token.split - 2);
 
-	check_if_option_exists("Unrecognized Option: --", temp_alias, command_line_settings_map.count(temp_alias), true);
+	CLI_Interface * option = find_option(alias);
+	if (option == nullptr) {
+		fail(Parse_Error_Code::unrecognized_option, i, alias, "--");
+		return;
+	}
 
-	if (command_line_settings_map[temp_alias]->ignored()) {
-		if (command_line_settings_map[temp_alias]->takes_args()) {
-			temp_alias[split_location - 1] = '=';
-		}
-		non_options.push_back(argv[i]);
+	if (option->ignored()) {
+		record_option(option, i);
+		add_non_option(argv[i]);
 		return;
 	}
 
 	// case: --long-option=value
-	if (temp_alias[split_location] != '\0') {
-		if (command_line_settings_map[temp_alias]->takes_args()) {
-			command_line_settings_map[temp_alias]->set_base_variable(temp_alias + split_location);
-			temp_alias[split_location - 1] = '=';
+	if (token.split + 1 < token.length) {
+		if (option->takes_args()) {
+			set_option(option, argv[i] + token.split + 1, i);
 		} else {
-			std::string error_message;
-			error_message.reserve(1024);
-			error_message += "Option does not take arguments: --";
-			error_message += temp_alias;
-			throw std::invalid_argument(error_message);
+			fail(Parse_Error_Code::option_takes_no_arguments, i, alias, "--");
 		}
 	// case: --long-option
-	} else if (command_line_settings_map[temp_alias]->takes_args()) {
-		std::string error_message;
-		error_message.reserve(1024);
-		error_message += "Option requires arguments: --";
-		error_message += temp_alias;
-		throw std::invalid_argument(error_message);
+	} else if (option->takes_args()) {
+		fail(Parse_Error_Code::option_requires_arguments, i, alias, "--");
 	} else {
-		command_line_settings_map[temp_alias]->set_base_variable(temp_alias);
+		set_option(option, temp_alias, i);
 	}
 }
 
-inline void Parser::short_option_handling(int argc, char ** argv, int& i) {
-	char temp_alias[2] = "\0";
-	temp_alias[0] = argv[i][1];
-
-	check_if_option_exists("Unrecognized Option: -", temp_alias, command_line_settings_map.count(temp_alias), true);
+CPP_CLI_INLINE void Parser::short_option_handling(int argc, const char * const * argv, const Arg_Token& token, int& i) {
+	CLI_Interface * option = find_option(Arg_View(argv[i] + 1, 1));
+	if (option == nullptr) {
+		fail(Parse_Error_Code::unrecognized_option, i, Arg_View(argv[i] + 1, 1), "-");
+		return;
+	}
 
-	if (command_line_settings_map[temp_alias]->ignored()) {
-		non_options.push_back(argv[i]);
+	if (option->ignored()) {
+		record_option(option, i);
+		add_non_option(argv[i]);
 		return;
 	}
 
-	// case: -o value // -o already exists because we checked for it initally.
-	if (argv[i][2] == '\0' && i + 1 < argc && command_line_settings_map[argv[i] + 1]->takes_args()) {
-		command_line_settings_map[argv[i] + 1]->set_base_variable(argv[i + 1]);
+	// case: -o value
+	if (token.length == 2 && i + 1 < argc && option->takes_args()) {
+		set_option(option, argv[i + 1], i + 1);
 		i++;
 		return;
 	}
 
 	// case: -oValue
-	if (command_line_settings_map[temp_alias]->takes_args()) {
-		command_line_settings_map[temp_alias]->set_base_variable(argv[i] + 2);
+	if (option->takes_args()) {
+		set_option(option, argv[i] + 2, i);
 		return;
 	}
 
 	// case: -abc or -vvv
-	multiple_short_options_handling(argc, argv, i);
+	multiple_short_options_handling(argc, argv, token, i);
 }
 
-inline void Parser::multiple_short_options_handling(int argc, char ** argv, int& cur_argument) {
-	int i = 0;
-	char * flag = argv[cur_argument] + 1;
+CPP_CLI_INLINE void Parser::multiple_short_options_handling(int argc, const char * const * argv, const Arg_Token& token, int& cur_argument) {
+	size_t i = 0;
+	const char * flag = argv[cur_argument] + 1;
+	size_t flag_length = token.length - 1;
 	char temp_alias[2] = "\0";
 
 	// case -vvv
-	std::string temp_repetition;
-	temp_repetition.reserve(32);
-	bool repeated_short_arguments = false;
-	while (flag[i] != '\0' && flag[i] == flag[0]) {
-		repeated_short_arguments = true;
-		temp_repetition.push_back(flag[i]);
+	while (i < flag_length && flag[i] == flag[0]) {
 		i++;
 	}
 
-	if (repeated_short_arguments) {
-		temp_alias[0] = temp_repetition[0];
-		command_line_settings_map[temp_alias]->set_base_variable(std::to_string(temp_repetition.length()).c_str());
+	if (i > 0) {
+		CLI_Interface * option = find_option(Arg_View(flag, 1));
+		if (option == nullptr) {
+			fail(Parse_Error_Code::unrecognized_option, cur_argument, Arg_View(flag, 1), "-");
+			return;
+		}
+		record_option(option, cur_argument);
+		if (!take_action(option)) {
+			option->set_repetitions(Arg_View(flag, 1), i);
+		}
 	}
 		
 	// case -abc
-	while (flag[i] != '\0') {
+	while (i < flag_length && !error && action_option == nullptr) {
 		temp_alias[0] = flag[i];
 
-		check_if_option_exists("Unrecognized Option: -", temp_alias, command_line_settings_map.count(temp_alias), true);
+		CLI_Interface * option = find_option(Arg_View(temp_alias, 1));
+		if (option == nullptr) {
+			fail(Parse_Error_Code::unrecognized_option, cur_argument, Arg_View(flag + i, 1), "-");
+			return;
+		}
 
-		if (command_line_settings_map[temp_alias]->ignored()) {
-			std::string error_message;
-			error_message.reserve(128);
-			error_message += "Order of -";
-			error_message += flag[i];
-			error_message += " matters, so it cannoth be part of multiple short arguments.";
-			throw std::invalid_argument(error_message);
+		if (option->ignored()) {
+			fail(Parse_Error_Code::option_order_matters, cur_argument, Arg_View(flag + i, 1), "-");
+			return;
 		}
-		if (command_line_settings_map[temp_alias]->takes_args()) {
-			if (flag[i + 1] != '\0' || cur_argument + 1 >= argc) {
-				std::string error_message;
-				error_message.reserve(64);
-				error_message += "Option requires arguments: ";
-				error_message += flag[i];
-				throw std::invalid_argument(error_message);
+		if (option->takes_args()) {
+			if (i + 1 < flag_length || cur_argument + 1 >= argc) {
+				fail(Parse_Error_Code::option_requires_arguments, cur_argument, Arg_View(flag + i, 1), "");
+				return;
 			} else {
 				cur_argument++;
-				command_line_settings_map[temp_alias]->set_base_variable(argv[cur_argument]);
+				set_option(option, argv[cur_argument], cur_argument);
 				break;
 			}
 		} else {
-			command_line_settings_map[temp_alias]->set_base_variable(temp_alias);
+			set_option(option, temp_alias, cur_argument);
 		}
 		i++;
 	}
 }
 
-void Parser::set_usage(const std::string& u) {
-	help_manager.set_usage(u);
+CPP_CLI_INLINE void Parser::set_usage(const std::string& u) {
+	help_manager().set_usage(u);
 }
-void Parser::set_header(const std::string& h) {
-	help_manager.set_header(h);
+CPP_CLI_INLINE void Parser::set_header(const std::string& h) {
+	help_manager().set_header(h);
 }
-void Parser::set_footer(const std::string& f) {
-	help_manager.set_footer(f);
+CPP_CLI_INLINE void Parser::set_footer(const std::string& f) {
+	help_manager().set_footer(f);
 }
-void Parser::set_help_width(size_t hw) {
-	help_manager.set_help_width(hw);
+CPP_CLI_INLINE void Parser::set_help_width(size_t hw) {
+	help_manager().set_help_width(hw);
 }
-void Parser::set_help_file_path(const std::string& hfp) {
-	help_manager.set_help_file_path(hfp);
+CPP_CLI_INLINE void Parser::set_help_file_path(const std::string& hfp) {
+	help_manager().set_help_file_path(hfp);
 }
-void Parser::generate_help(const char * subcommand_name) {
-	help_manager.generate_help(subcommand_name, subcommand_aliases, list_of_cmd_var);
+// Only names the help file, so that print_help knows where it is. The file
+// is written once parsing is done, unless an action ended it, or by
+// print_help, so --version costs no help file. Errors writing it are thrown
+// from there.
+CPP_CLI_INLINE void Parser::generate_help(const char * subcommand_name) {
+	CLI_Help& help = help_manager();
+	help.name_help_file(subcommand_name);
+	pending_help.settings = help;
+	pending_help.file_name = CLI_Help::help_file_name();
+	pending_help.command_list = CLI_Help::current_command_list();
+	help_pending = true;
 }
-void Parser::print_help() {
-	help_manager.print_help();
+CPP_CLI_INLINE void Parser::print_help() {
+	write_pending_help();
+	help_manager().print_help();
 }
 
-template <typename T>
-CLI_Interface * Parser::arg(T& var, std::vector<const char *> flags, const char * help_message) {
-	list_of_cmd_var.push_back(new Var<T>(var, flags, true, help_message));
-	return list_of_cmd_var.back();
+CPP_CLI_INLINE void Parser::write_pending_help() {
+	if (!help_pending) {
+		return;
+	}
+	help_pending = false;
+	// A help file left by an earlier run of the same program is kept as is.
+	uint64_t key = pending_help.settings.help_key(pending_help.command_list, subcommand_help_names, subcommand_descriptions, list_of_cmd_var);
+	if (CLI_Help::help_file_current(pending_help.file_name, key)) {
+		return;
+	}
+	std::string contents;
+	pending_help.settings.build_help(contents, pending_help.command_list, subcommand_help_names, subcommand_descriptions, list_of_cmd_var);
+	CLI_Help::write_help_file(pending_help.file_name, contents, key);
 }
 
-template <typename T>
-CLI_Interface * Parser::value(T& var, std::vector<const char *> flags, T to_set, const char * help_message) {
-	list_of_cmd_var.push_back(new Value<T>(var, flags, to_set, help_message));
-	return list_of_cmd_var.back();
+// Bound to the parser's Intern_Pool, so every occurrence of the same value
+// shares one copy, which lives as long as the parser.
+CPP_CLI_INLINE CLI_Interface * Parser::arg(Interned& var, std::vector<const char *> flags, const char * help_message) {
+	return add_option<Var<Interned>>(var, &interned_strings, std::move(flags), help_message);
 }
 
-template <typename T>
-CLI_Interface * Parser::vector(std::vector<T>& var, std::vector<const char *> flags, const char * help_message) {
-	list_of_cmd_var.push_back(new Vector<T>(var, flags, help_message));
-	return list_of_cmd_var.back();
+CPP_CLI_INLINE CLI_Interface * Parser::vector(std::vector<Interned>& var, std::vector<const char *> flags, const char * help_message) {
+	return add_option<Vector<Interned>>(var, &interned_strings, std::move(flags), help_message);
 }
 
-CLI_Interface * Parser::ignored(std::vector<const char *> flags, const char * help_message) {
-	list_of_cmd_var.push_back(new Var<int>(nullptr, flags, false, help_message));
-	return list_of_cmd_var.back();
+// Interns a string in the same pool as the bound Interned variables, so that
+// they can be compared with it by pointer.
+CPP_CLI_INLINE Interned Parser::intern(Arg_View value) {
+	return interned_strings.intern(value);
 }
 
-CLI_Interface * Parser::repeated(size_t& var, std::vector<const char *> flags, const char * help_message) {
-	list_of_cmd_var.push_back(new Var<size_t>(var, flags, false, help_message));
-	return list_of_cmd_var.back();
+CPP_CLI_INLINE CLI_Interface * Parser::sink(argument_sink sink, void * sink_data, std::vector<const char *> flags, const char * help_message) {
+	return add_option<Sink>(sink, sink_data, std::move(flags), help_message);
+}
+
+CPP_CLI_INLINE CLI_Interface * Parser::ignored(std::vector<const char *> flags, const char * help_message) {
+	return add_option<Var<int>>(nullptr, std::move(flags), false, help_message);
+}
+
+// The same as count, kept for programs that already use it.
+CPP_CLI_INLINE CLI_Interface * Parser::repeated(size_t& var, std::vector<const char *> flags, const char * help_message) {
+	return count(var, std::move(flags), help_message);
+}
+
+// function is called with the parser that sees one of flags and action_data,
+// and nothing after it is parsed. parse then returns normally, with the
+// variables set by the arguments before it, and the selected command does not
+// run. The function may also exit itself.
+CPP_CLI_INLINE CLI_Interface * Parser::action(action_func function, void * action_data, std::vector<const char *> flags, const char * help_message) {
+	CLI_Interface * option = add_option<Action>(function, action_data, std::move(flags), help_message);
+	const std::vector<const char *>& aliases = option->get_aliases();
+	for (size_t i = 0; i < aliases.size(); i++) {
+		action_table.insert(Arg_View(aliases[i]), option);
+	}
+	return option;
 }
-CLI_Help Parser::help_manager = CLI_Help();
+
+// The action that ended the last parse, or null if none did.
+CPP_CLI_INLINE const CLI_Interface * Parser::action_taken() const {
+	return action_option;
+}
+
+// Makes parsing fail unless option is given.
+CPP_CLI_INLINE CLI_Interface * Parser::required(CLI_Interface * option) {
+	add_constraint(Option_Constraint::required, 0, std::vector<CLI_Interface *>(1, option));
+	return option;
+}
+
+// Makes parsing fail if more than one of options is given.
+CPP_CLI_INLINE void Parser::exclusive(std::vector<CLI_Interface *> options) {
+	add_constraint(Option_Constraint::exclusive, 0, options);
+}
+
+// Makes parsing fail if option is given without every one of dependencies.
+CPP_CLI_INLINE CLI_Interface * Parser::depends_on(CLI_Interface * option, std::vector<CLI_Interface *> dependencies) {
+	add_constraint(Option_Constraint::dependency, constrained_option(option), dependencies);
+	return option;
+}
+
+// Whether option was set by the last parse, by any parser. Unlike comparing
+// the variable with its default, this also tells a default given on purpose
+// apart from none.
+CPP_CLI_INLINE bool Parser::seen(const CLI_Interface * option) const {
+	const Parser * owner = option->owner;
+	uint32_t i = option->option_index;
+	if (owner == nullptr || i >= owner->option_records.size()) {
+		return false;
+	}
+	return (owner->seen_options[i / 64] >> (i % 64) & 1) != 0;
+}
+
+CPP_CLI_INLINE Option_Record Parser::provenance(const CLI_Interface * option) const {
+	const Parser * owner = option->owner;
+	uint32_t i = option->option_index;
+	if (owner == nullptr || i >= owner->option_records.size()) {
+		return { -1, Option_Source::unset };
+	}
+	return owner->option_records[i];
+}
+#endif
+
+
+// Adding the options for the built in types, instantiated along with them in
+// template_definitions.h.
+#ifdef CPP_CLI_INSTANTIATION
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::arg(bool& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::arg(int& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::arg(unsigned int& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::arg(long& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::arg(unsigned long& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::arg(long long& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::arg(unsigned long long& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::arg(float& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::arg(double& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::arg(long double& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::arg(std::string& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::arg(const char *& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::vector(std::vector<bool>& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::vector(std::vector<char>& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::vector(std::vector<int>& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::vector(std::vector<unsigned int>& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::vector(std::vector<long>& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::vector(std::vector<unsigned long>& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::vector(std::vector<long long>& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::vector(std::vector<unsigned long long>& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::vector(std::vector<float>& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::vector(std::vector<double>& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::vector(std::vector<long double>& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::vector(std::vector<std::string>& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::vector(std::vector<const char *>& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::value(bool& var, std::vector<const char *> flags, bool to_set, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::value(int& var, std::vector<const char *> flags, int to_set, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::value(unsigned int& var, std::vector<const char *> flags, unsigned int to_set, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::value(long& var, std::vector<const char *> flags, long to_set, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::value(unsigned long& var, std::vector<const char *> flags, unsigned long to_set, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::value(long long& var, std::vector<const char *> flags, long long to_set, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::value(unsigned long long& var, std::vector<const char *> flags, unsigned long long to_set, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::value(float& var, std::vector<const char *> flags, float to_set, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::value(double& var, std::vector<const char *> flags, double to_set, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::value(long double& var, std::vector<const char *> flags, long double to_set, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::value(std::string& var, std::vector<const char *> flags, std::string to_set, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::value(const char *& var, std::vector<const char *> flags, const char * to_set, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::count(int& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::count(unsigned int& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::count(long& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::count(unsigned long& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::count(long long& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::count(unsigned long long& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::sum(int& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::sum(unsigned int& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::sum(long& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::sum(unsigned long& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::sum(long long& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::sum(unsigned long long& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::sum(float& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::sum(double& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::sum(long double& var, std::vector<const char *> flags, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::bits(unsigned int& word, std::vector<std::pair<const char *, unsigned int>> bits, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::bits(unsigned long& word, std::vector<std::pair<const char *, unsigned long>> bits, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::bits(unsigned long long& word, std::vector<std::pair<const char *, unsigned long long>> bits, const char * help_message);
+CPP_CLI_INSTANTIATION CLI_Interface * Parser::choice(int& var, std::vector<const char *> flags, std::vector<std::pair<const char *, int>> choices, const char * help_message);
+#endif
 }
 #endif
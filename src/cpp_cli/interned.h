@@ -0,0 +1,261 @@
+#ifndef INTERNED_H
+#define INTERNED_H
+#include "args_parser_templates.h"
+#include "template_definitions.h"
+#include "arg_view.h"
+#include "cli_containers.h"
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace cli {
+
+class Intern_Pool;
+
+// A string stored once in an Intern_Pool. Equal strings from the same pool
+// share their characters, so comparing two handles only compares pointers,
+// and copying one copies two words. A handle is valid as long as its pool,
+// which for a bound variable is the Parser it was bound with. Handles from
+// different pools must not be compared.
+class Interned {
+friend class Intern_Pool;
+private:
+	const char * characters;
+	size_t length;
+private:
+	Interned(const char * c, size_t l) : characters(c), length(l) {}
+	static const char * empty_string();
+public:
+	Interned() : characters(empty_string()), length(0) {}
+	const char * c_str() const;
+	size_t size() const;
+	bool empty() const;
+	Arg_View view() const;
+	std::string str() const;
+};
+
+// The same in every translation unit, so that every empty handle is equal.
+inline const char * Interned::empty_string() {
+	static const char empty[1] = "";
+	return empty;
+}
+
+inline const char * Interned::c_str() const {
+	return characters;
+}
+
+inline size_t Interned::size() const {
+	return length;
+}
+
+inline bool Interned::empty() const {
+	return length == 0;
+}
+
+inline Arg_View Interned::view() const {
+	return Arg_View(characters, length);
+}
+
+inline std::string Interned::str() const {
+	return std::string(characters, length);
+}
+
+inline bool operator==(const Interned& a, const Interned& b) {
+	return a.c_str() == b.c_str();
+}
+
+inline bool operator!=(const Interned& a, const Interned& b) {
+	return a.c_str() != b.c_str();
+}
+
+// Hashes the pointer, not the characters.
+struct Interned_Hash {
+	size_t operator()(const Interned& value) const {
+		return std::hash<const void *>()(value.c_str());
+	}
+};
+
+// Hash-consed strings in arena chunks. Every distinct string is copied once,
+// terminated, into the current chunk, and looking up one that is already
+// there allocates nothing. Nothing is freed before the pool is destroyed, so
+// handles never dangle while it lives. A pool is not thread safe.
+class Intern_Pool {
+private:
+	static const size_t chunk_size = 4096;
+	cli_vector<cli_vector<char>> chunks;
+	size_t chunk_used = 0;
+	// Views of the interned copies, so a lookup builds no string.
+	cli_hash_set<Arg_View, Arg_View_Hash> strings;
+private:
+	char * allocate(size_t n);
+public:
+	Intern_Pool() {}
+#ifdef CPP_CLI_PMR
+	explicit Intern_Pool(cli_memory_resource * resource) : chunks(resource), strings(resource) {}
+#endif
+	Intern_Pool(const Intern_Pool&) = delete;
+	Intern_Pool& operator=(const Intern_Pool&) = delete;
+	Interned intern(Arg_View value);
+	// The number of distinct strings.
+	size_t size() const;
+};
+
+#ifdef CPP_CLI_DEFINITIONS
+CPP_CLI_INLINE char * Intern_Pool::allocate(size_t n) {
+	if (chunks.empty() || chunks.back().size() - chunk_used < n) {
+		chunks.emplace_back();
+		chunks.back().resize(n > chunk_size ? n : chunk_size);
+		chunk_used = 0;
+	}
+	char * memory = chunks.back().data() + chunk_used;
+	chunk_used += n;
+	return memory;
+}
+
+CPP_CLI_INLINE Interned Intern_Pool::intern(Arg_View value) {
+	if (value.empty()) {
+		return Interned();
+	}
+	cli_hash_set<Arg_View, Arg_View_Hash>::const_iterator it = strings.find(value);
+	if (it != strings.end()) {
+		return Interned(it->data, it->length);
+	}
+	char * copy = allocate(value.length + 1);
+	memcpy(copy, value.data, value.length);
+	copy[value.length] = '\0';
+	strings.insert(Arg_View(copy, value.length));
+	return Interned(copy, value.length);
+}
+#endif
+
+inline size_t Intern_Pool::size() const {
+	return strings.size();
+}
+
+// A handle only means something in the process that made it. Var<Interned>
+// and Vector<Interned> save the characters instead and intern them again.
+template <>
+struct Snapshot_Codec<Interned> : Trivial_Snapshot_Codec<Interned, false> {};
+
+template <>
+struct Argument_Format<Interned> {
+	static bool format(const Interned& value, char (&scratch)[64], Arg_View& arg) {
+		(void)scratch;
+		arg = value.view();
+		return true;
+	}
+};
+
+// Bound with Parser::arg and Parser::vector, which hand them the parser's
+// pool. They share it with every other interned option of the parser, so they
+// are converted while parse_parallel splits up the command line rather than
+// on its threads.
+template<>
+class Var<Interned> : public CLI_Interface {
+private:
+	Intern_Pool * pool;
+public:
+	Var(Interned & b_v, Intern_Pool * p, std::vector<const char *> a, const char * hm = "");
+	virtual void set_base_variable(const char * b_v);
+	virtual bool converts_in_parallel() const;
+	virtual size_t write_snapshot(char * out) const;
+	virtual bool read_snapshot(const char * data, size_t size);
+	virtual void write_arguments(Argv_Writer& writer) const;
+};
+
+template<>
+class Vector<Interned> : public CLI_Interface {
+private:
+	Intern_Pool * pool;
+public:
+	Vector(std::vector<Interned> & b_v, Intern_Pool * p, std::vector<const char *> a, const char * hm = "");
+	virtual void set_base_variable(const char * b_v);
+	virtual bool converts_in_parallel() const;
+	virtual size_t write_snapshot(char * out) const;
+	virtual bool read_snapshot(const char * data, size_t size);
+	virtual void write_arguments(Argv_Writer& writer) const;
+};
+
+#ifdef CPP_CLI_DEFINITIONS
+CPP_CLI_INLINE Var<Interned>::Var(Interned & b_v, Intern_Pool * p, std::vector<const char *> a, const char * hm) : CLI_Interface(&b_v, std::move(a), true, hm), pool(p) {}
+
+CPP_CLI_INLINE void Var<Interned>::set_base_variable(const char * b_v) {
+	*(Interned *)base_variable = pool->intern(Arg_View(b_v));
+}
+
+CPP_CLI_INLINE bool Var<Interned>::converts_in_parallel() const {
+	return false;
+}
+
+CPP_CLI_INLINE size_t Var<Interned>::write_snapshot(char * out) const {
+	return Snapshot_Codec<Arg_View>::write(((const Interned *)base_variable)->view(), out);
+}
+
+CPP_CLI_INLINE bool Var<Interned>::read_snapshot(const char * data, size_t size) {
+	Arg_View value;
+	if (Snapshot_Codec<Arg_View>::read(value, data, size) != size) {
+		return false;
+	}
+	*(Interned *)base_variable = pool->intern(value);
+	return true;
+}
+
+CPP_CLI_INLINE void Var<Interned>::write_arguments(Argv_Writer& writer) const {
+	write_flag_with_value(writer, aliases, *(const Interned *)base_variable);
+}
+
+CPP_CLI_INLINE Vector<Interned>::Vector(std::vector<Interned> & b_v, Intern_Pool * p, std::vector<const char *> a, const char * hm) : CLI_Interface(&b_v, std::move(a), true, hm), pool(p) {}
+
+CPP_CLI_INLINE void Vector<Interned>::set_base_variable(const char * b_v) {
+	std::vector<Interned>& base_variable_vector = *(std::vector<Interned> *)base_variable;
+	base_variable_vector.push_back(pool->intern(Arg_View(b_v)));
+}
+
+CPP_CLI_INLINE bool Vector<Interned>::converts_in_parallel() const {
+	return false;
+}
+
+// Saved as a count followed by the characters of every element, the same way
+// a std::vector<Arg_View> is.
+CPP_CLI_INLINE size_t Vector<Interned>::write_snapshot(char * out) const {
+	const std::vector<Interned>& base_variable_vector = *(const std::vector<Interned> *)base_variable;
+	size_t n = write_snapshot_length(base_variable_vector.size(), out);
+	for (size_t i = 0; i < base_variable_vector.size(); i++) {
+		n += Snapshot_Codec<Arg_View>::write(base_variable_vector[i].view(), out == nullptr ? nullptr : out + n);
+	}
+	return n;
+}
+
+CPP_CLI_INLINE bool Vector<Interned>::read_snapshot(const char * data, size_t size) {
+	std::vector<Interned>& base_variable_vector = *(std::vector<Interned> *)base_variable;
+	uint64_t count;
+	if (!read_snapshot_length(count, data, size)) {
+		return false;
+	}
+	size_t n = sizeof(count);
+	base_variable_vector.clear();
+	// Every element takes at least one byte, which bounds a corrupt count.
+	base_variable_vector.reserve(count < size ? count : size);
+	for (uint64_t i = 0; i < count; i++) {
+		Arg_View value;
+		size_t used = Snapshot_Codec<Arg_View>::read(value, data + n, size - n);
+		if (used == 0) {
+			return false;
+		}
+		base_variable_vector.push_back(pool->intern(value));
+		n += used;
+	}
+	return n == size;
+}
+
+CPP_CLI_INLINE void Vector<Interned>::write_arguments(Argv_Writer& writer) const {
+	const std::vector<Interned>& base_variable_vector = *(const std::vector<Interned> *)base_variable;
+	for (size_t i = 0; i < base_variable_vector.size(); i++) {
+		write_flag_with_value(writer, aliases, base_variable_vector[i]);
+	}
+}
+#endif
+
+}
+#endif
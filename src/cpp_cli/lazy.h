@@ -0,0 +1,124 @@
+#ifndef LAZY_H
+#define LAZY_H
+#include "args_parser_templates.h"
+#include "template_definitions.h"
+
+namespace cli {
+
+// A variable whose argument is only converted the first time it is read. Bind
+// it like any other variable, e.g. p.arg(lazy_var, { "j", "jobs" }), and parse
+// only stores a pointer to the argument. The converted value is cached, so
+// the conversion runs at most once per argument.
+//
+// If the option was not given, the value comes from the default provider,
+// which is also only called the first time the value is read, so expensive
+// defaults like counting CPUs cost nothing on code paths that never use them.
+//
+// The argument is not copied, so it must outlive the Lazy, which argv does.
+// Reading a Lazy is not thread safe.
+template <typename T>
+class Lazy {
+public:
+	typedef T (*default_provider)();
+private:
+	const char * raw_value;
+	default_provider provider;
+	T value;
+	bool converted;
+public:
+	Lazy();
+	Lazy(const T& default_value);
+	Lazy(default_provider p);
+
+	Lazy& operator=(const char * b_v);
+
+	bool given() const;
+	const char * raw() const;
+	const T& get();
+	const T& operator*();
+	const T * operator->();
+};
+
+template <typename T>
+inline Lazy<T>::Lazy() : raw_value(nullptr), provider(nullptr), value(), converted(true) {}
+
+template <typename T>
+inline Lazy<T>::Lazy(const T& default_value) : raw_value(nullptr), provider(nullptr), value(default_value), converted(true) {}
+
+template <typename T>
+inline Lazy<T>::Lazy(default_provider p) : raw_value(nullptr), provider(p), value(), converted(false) {}
+
+template <typename T>
+inline Lazy<T>& Lazy<T>::operator=(const char * b_v) {
+	raw_value = b_v;
+	converted = false;
+	return *this;
+}
+
+template <typename T>
+inline bool Lazy<T>::given() const {
+	return raw_value != nullptr;
+}
+
+template <typename T>
+inline const char * Lazy<T>::raw() const {
+	return raw_value;
+}
+
+template <typename T>
+inline const T& Lazy<T>::get() {
+	if (!converted) {
+		if (raw_value != nullptr) {
+			Var<T> temp_var(value, {}, true);
+			temp_var.set_base_variable(raw_value);
+		} else {
+			value = provider();
+		}
+		converted = true;
+	}
+	return value;
+}
+
+template <typename T>
+inline const T& Lazy<T>::operator*() {
+	return get();
+}
+
+template <typename T>
+inline const T * Lazy<T>::operator->() {
+	return &get();
+}
+
+// Only the argument is saved, so a restored Lazy still converts it the first
+// time it is read, and keeps its default if the option was not given.
+template <typename T>
+struct Snapshot_Codec<Lazy<T>> {
+	static const bool supported = true;
+	static size_t write(const Lazy<T>& value, char * out) {
+		return Snapshot_Codec<const char *>::write(value.raw(), out);
+	}
+	static size_t read(Lazy<T>& value, const char * data, size_t size) {
+		const char * raw = nullptr;
+		size_t used = Snapshot_Codec<const char *>::read(raw, data, size);
+		if (used != 0 && raw != nullptr) {
+			value = raw;
+		}
+		return used;
+	}
+};
+
+// The argument is written back as it was given, without converting it.
+template <typename T>
+struct Argument_Format<Lazy<T>> {
+	static bool format(const Lazy<T>& value, char (&scratch)[64], Arg_View& arg) {
+		(void)scratch;
+		if (!value.given()) {
+			return false;
+		}
+		arg = Arg_View(value.raw());
+		return true;
+	}
+};
+
+}
+#endif
@@ -0,0 +1,166 @@
+#ifndef PARALLEL_PARSE_H
+#define PARALLEL_PARSE_H
+#include "cpp_cli.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace cli {
+
+// Calls f(i) for every i in [0, n) using up to num_threads threads, including
+// the calling thread. Indices are handed out in chunks so that threads do not
+// fight over the counter when every call is cheap. Pass a chunk_size of 1 when
+// every call is expensive.
+//
+// This is not a thread pool. The threads are started on every call and joined
+// before it returns, since a pool kept between calls would not survive the
+// fork cli::serve makes for every command line. If a thread cannot be started,
+// the threads already running share the work. If f throws on the calling
+// thread, no more indices are handed out and the other threads are joined
+// before the exception is rethrown. An exception on any other thread ends the
+// program, so f should catch its own, as the callers in this library do.
+template <typename F>
+inline void parallel_for(size_t n, size_t num_threads, F f, size_t chunk_size = 64) {
+	std::atomic<size_t> next(0);
+	auto worker = [&]() {
+		for (;;) {
+			size_t begin = next.fetch_add(chunk_size);
+			if (begin >= n) {
+				return;
+			}
+			size_t end = std::min(begin + chunk_size, n);
+			for (size_t i = begin; i < end; i++) {
+				f(i);
+			}
+		}
+	};
+	size_t num_workers = std::min(num_threads, (n + chunk_size - 1) / chunk_size);
+	std::vector<std::thread> threads;
+	threads.reserve(num_workers);
+	auto join_all = [&]() {
+		for (size_t i = 0; i < threads.size(); i++) {
+			threads[i].join();
+		}
+	};
+	CLI_TRY {
+		for (size_t i = 1; i < num_workers; i++) {
+			threads.push_back(std::thread(worker));
+		}
+	} CLI_CATCH_ALL {
+		// Carry on with the threads that did start.
+	}
+	CLI_TRY {
+		worker();
+	} CLI_CATCH_ALL {
+		next.store(n);
+		join_all();
+		CLI_RETHROW;
+	}
+	join_all();
+}
+
+inline bool deferred_value_less(const Deferred_Value& a, const Deferred_Value& b) {
+	return a.option < b.option;
+}
+
+// Converts every value recorded by parse_parallel. Every value of an option
+// that appends, such as a Vector, is converted on its own, in parallel, into a
+// slot reserved in command line order. The values of any other option are
+// converted one after another so that the last one still wins. If any
+// conversions throw, the exception from the earliest argument is rethrown, so
+// the error does not depend on how the threads were scheduled.
+inline void convert_deferred_values(Parser& p) {
+	struct Work_Item {
+		CLI_Interface * option;
+		size_t begin;
+		size_t end;
+		size_t slot;
+	};
+	const size_t no_slot = (size_t)-1;
+
+	cli_vector<Deferred_Value> values = make_container<cli_vector<Deferred_Value>>(p.resource);
+	values.swap(p.deferred_values);
+	std::stable_sort(values.begin(), values.end(), deferred_value_less);
+
+	cli_vector<Work_Item> items = make_container<cli_vector<Work_Item>>(p.resource);
+	items.reserve(values.size());
+	for (size_t begin = 0; begin < values.size();) {
+		CLI_Interface * option = values[begin].option;
+		size_t end = begin;
+		while (end < values.size() && values[end].option == option) {
+			end++;
+		}
+		if (option->appends()) {
+			size_t first_slot = option->append_slots(end - begin);
+			for (size_t i = begin; i < end; i++) {
+				items.push_back({ option, i, i + 1, first_slot + i - begin });
+			}
+		} else {
+			items.push_back({ option, begin, end, no_slot });
+		}
+		begin = end;
+	}
+
+	cli_vector<std::exception_ptr> errors = make_container<cli_vector<std::exception_ptr>>(p.resource);
+	errors.resize(items.size());
+	cli_vector<int> error_indices = make_container<cli_vector<int>>(p.resource);
+	error_indices.resize(items.size(), -1);
+	parallel_for(items.size(), p.num_conversion_threads, [&](size_t w) {
+		const Work_Item& item = items[w];
+		size_t i = item.begin;
+		CLI_TRY {
+			for (; i < item.end; i++) {
+				if (item.slot != no_slot) {
+					item.option->set_slot(item.slot, values[i].value);
+				} else {
+					item.option->set_base_variable(values[i].value);
+				}
+			}
+		} CLI_CATCH_ALL {
+#ifdef CPP_CLI_EXCEPTIONS
+			errors[w] = std::current_exception();
+#endif
+			error_indices[w] = values[i].index;
+		}
+	});
+
+	size_t first_error = items.size();
+	for (size_t w = 0; w < items.size(); w++) {
+		if (errors[w] && (first_error == items.size() || error_indices[w] < error_indices[first_error])) {
+			first_error = w;
+		}
+	}
+#ifdef CPP_CLI_EXCEPTIONS
+	if (first_error != items.size()) {
+		std::rethrow_exception(errors[first_error]);
+	}
+#endif
+}
+
+// Parses in two phases. The command line is split up first, setting every
+// option that does not take arguments as usual but only recording the values
+// of the options that do. The recorded values are then converted on up to
+// num_threads threads. Options that take arguments should not share a
+// variable with any other option, since they are converted after the rest.
+inline std::vector<const char *> parse_parallel(Parser& p, int argc, const char * const * argv, size_t num_threads, void * data = nullptr) {
+	p.deferred_converter = convert_deferred_values;
+	p.num_conversion_threads = num_threads == 0 ? 1 : num_threads;
+	p.deferred_values.clear();
+	p.deferred_values.reserve(argc);
+	std::vector<const char *> non_options;
+	CLI_TRY {
+		non_options = p.parse(argc, argv, data);
+		convert_deferred_values(p);
+	} CLI_CATCH_ALL {
+		p.deferred_converter = nullptr;
+		p.deferred_values.clear();
+		CLI_RETHROW;
+	}
+	p.deferred_converter = nullptr;
+	return non_options;
+}
+
+}
+#endif
@@ -0,0 +1,140 @@
+#ifndef PARSE_ERROR_H
+#define PARSE_ERROR_H
+#include "args_parser_templates.h"
+#include "argv_writer.h"
+#include <string>
+
+namespace cli {
+
+enum class Parse_Error_Code {
+	none,
+	unrecognized_option,
+	option_takes_no_arguments,
+	option_requires_arguments,
+	option_order_matters,
+	invalid_value,
+	flag_already_used,
+	subcommand_already_used,
+	missing_required_option,
+	exclusive_options,
+	missing_dependency,
+	// The first argument of a segment given to parse_batch names no command.
+	unknown_command
+};
+
+// Why a command line could not be parsed, as returned by Parser::try_parse.
+// Recording one copies a few pointers and nothing else, so the message is not
+// built, and nothing is allocated, unless message is called. index is the
+// argv index of the offending argument, or -1 if the options themselves are
+// wrong, such as a flag that is used twice. token views the flag or value in
+// argv or in the alias it names and is only valid as long as they are.
+struct Parse_Error {
+	Parse_Error_Code code = Parse_Error_Code::none;
+	int index = -1;
+	Arg_View token;
+	// What is printed in front of the token, such as "--" for a long option.
+	const char * flag_prefix = "";
+	// The option that rejected its value, for invalid_value, or that broke a
+	// constraint declared on the parser, together with other_option, the
+	// option it conflicts with or needs.
+	const CLI_Interface * option = nullptr;
+	const CLI_Interface * other_option = nullptr;
+
+	explicit operator bool() const;
+	std::string message() const;
+};
+
+inline Parse_Error::operator bool() const {
+	return code != Parse_Error_Code::none;
+}
+
+#ifdef CPP_CLI_DEFINITIONS
+// How an option is named in messages: its first long alias, or its first
+// short one.
+CPP_CLI_INLINE void append_option_name(std::string& error_message, const CLI_Interface * option) {
+	const std::vector<const char *>& aliases = option->get_aliases();
+	const char * alias = first_long_alias(aliases);
+	if (alias != nullptr) {
+		error_message += "--";
+		error_message += alias;
+		return;
+	}
+	alias = first_short_alias(aliases);
+	if (alias == nullptr) {
+		alias = aliases.empty() ? "" : aliases[0];
+	}
+	error_message += alias[0] == '-' ? "" : "-";
+	error_message += alias;
+}
+
+// The same text parse throws for the error.
+CPP_CLI_INLINE std::string Parse_Error::message() const {
+	if (code == Parse_Error_Code::invalid_value) {
+		return option->invalid_value_message(token);
+	}
+	std::string error_message;
+	error_message.reserve(128);
+	switch (code) {
+	case Parse_Error_Code::missing_required_option:
+		error_message += "Missing required option: ";
+		append_option_name(error_message, option);
+		return error_message;
+	case Parse_Error_Code::exclusive_options:
+		error_message += "Options cannot be used together: ";
+		append_option_name(error_message, option);
+		error_message += " and ";
+		append_option_name(error_message, other_option);
+		return error_message;
+	case Parse_Error_Code::missing_dependency:
+		error_message += "Option ";
+		append_option_name(error_message, option);
+		error_message += " requires ";
+		append_option_name(error_message, other_option);
+		return error_message;
+	default:
+		break;
+	}
+	const char * prefix = "";
+	switch (code) {
+	case Parse_Error_Code::none:
+		return std::string();
+	case Parse_Error_Code::unrecognized_option:
+		prefix = "Unrecognized Option: ";
+		break;
+	case Parse_Error_Code::option_takes_no_arguments:
+		prefix = "Option does not take arguments: ";
+		break;
+	case Parse_Error_Code::option_requires_arguments:
+		prefix = "Option requires arguments: ";
+		break;
+	case Parse_Error_Code::option_order_matters:
+		prefix = "Order of ";
+		break;
+	case Parse_Error_Code::invalid_value:
+		break;
+	case Parse_Error_Code::flag_already_used:
+		prefix = "Flag already used: ";
+		break;
+	case Parse_Error_Code::subcommand_already_used:
+		prefix = "Subcommand already used: ";
+		break;
+	case Parse_Error_Code::unknown_command:
+		prefix = "Unknown command: ";
+		break;
+	case Parse_Error_Code::missing_required_option:
+	case Parse_Error_Code::exclusive_options:
+	case Parse_Error_Code::missing_dependency:
+		break;
+	}
+	error_message += prefix;
+	error_message += flag_prefix;
+	error_message.append(token.data, token.length);
+	if (code == Parse_Error_Code::option_order_matters) {
+		error_message += " matters, so it cannoth be part of multiple short arguments.";
+	}
+	return error_message;
+}
+#endif
+
+}
+#endif
@@ -0,0 +1,95 @@
+#ifndef PARSE_RESULT_H
+#define PARSE_RESULT_H
+#include "cli_containers.h"
+#include <cstddef>
+
+namespace cli {
+
+// A contiguous run of arguments inside argv. Nothing is copied, so the span is
+// only valid as long as argv is.
+struct Arg_Span {
+	char ** data;
+	size_t length;
+
+	Arg_Span() : data(nullptr), length(0) {}
+	Arg_Span(char ** d, size_t l) : data(d), length(l) {}
+
+	char ** begin() const;
+	char ** end() const;
+	size_t size() const;
+	bool empty() const;
+	const char * operator[](size_t i) const;
+};
+
+inline char ** Arg_Span::begin() const {
+	return data;
+}
+
+inline char ** Arg_Span::end() const {
+	return data + length;
+}
+
+inline size_t Arg_Span::size() const {
+	return length;
+}
+
+inline bool Arg_Span::empty() const {
+	return length == 0;
+}
+
+inline const char * Arg_Span::operator[](size_t i) const {
+	return data[i];
+}
+
+// The arguments of one command: the program itself or a subcommand. name is
+// the argv[0] of that command. positionals are its non-options in order and
+// after_dash_dash everything after a "--". The two spans are adjacent.
+struct Command_Level {
+	const char * name;
+	Arg_Span positionals;
+	Arg_Span after_dash_dash;
+};
+
+// What Parser::parse_levels returns. Level 0 is the program and every level
+// after it is the subcommand run by the level before it.
+class Parse_Result {
+friend class Parser;
+private:
+	static const size_t no_level = (size_t)-1;
+
+	cli_vector<Command_Level> levels;
+	// The level the next nested parse fills. Set right before a subcommand
+	// runs.
+	size_t pending_level = no_level;
+public:
+	explicit Parse_Result(cli_memory_resource * resource = default_memory_resource()) : levels(make_container<cli_vector<Command_Level>>(resource)) {}
+
+	size_t size() const;
+	const Command_Level& operator[](size_t i) const;
+	const Command_Level& innermost() const;
+	cli_vector<Command_Level>::const_iterator begin() const;
+	cli_vector<Command_Level>::const_iterator end() const;
+};
+
+inline size_t Parse_Result::size() const {
+	return levels.size();
+}
+
+inline const Command_Level& Parse_Result::operator[](size_t i) const {
+	return levels[i];
+}
+
+inline const Command_Level& Parse_Result::innermost() const {
+	return levels.back();
+}
+
+inline cli_vector<Command_Level>::const_iterator Parse_Result::begin() const {
+	return levels.begin();
+}
+
+inline cli_vector<Command_Level>::const_iterator Parse_Result::end() const {
+	return levels.end();
+}
+
+}
+#endif
@@ -0,0 +1,252 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+#include "arg_view.h"
+#include "cli_errors.h"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <vector>
+
+namespace cli {
+
+inline size_t write_snapshot_length(uint64_t length, char * out) {
+	if (out != nullptr) {
+		memcpy(out, &length, sizeof(length));
+	}
+	return sizeof(length);
+}
+
+inline bool read_snapshot_length(uint64_t& length, const char * data, size_t size) {
+	if (size < sizeof(length)) {
+		return false;
+	}
+	memcpy(&length, data, sizeof(length));
+	return true;
+}
+
+template <typename T, bool = std::is_trivially_copyable<T>::value && !std::is_pointer<T>::value>
+struct Trivial_Snapshot_Codec {
+	static const bool supported = false;
+	static size_t write(const T& value, char * out) {
+		(void)value;
+		(void)out;
+		return 0;
+	}
+	static size_t read(T& value, const char * data, size_t size) {
+		(void)value;
+		(void)data;
+		(void)size;
+		return 0;
+	}
+};
+
+template <typename T>
+struct Trivial_Snapshot_Codec<T, true> {
+	static const bool supported = true;
+	static size_t write(const T& value, char * out) {
+		if (out != nullptr) {
+			memcpy(out, &value, sizeof(T));
+		}
+		return sizeof(T);
+	}
+	static size_t read(T& value, const char * data, size_t size) {
+		if (size < sizeof(T)) {
+			return 0;
+		}
+		memcpy(&value, data, sizeof(T));
+		return sizeof(T);
+	}
+};
+
+// How a bound variable of type T is saved into a snapshot image and read back.
+// write returns the number of bytes the value takes and only measures it if
+// out is null. read returns the number of bytes it used, or 0 if the data is
+// malformed. Values are copied with memcpy, so the image needs no alignment.
+// Trivially copyable types that are not pointers are copied byte for byte, so
+// they must not hold pointers either. Specialize it for any other type you
+// bind. Types without a codec are left out of the image.
+template <typename T>
+struct Snapshot_Codec : Trivial_Snapshot_Codec<T> {};
+
+// Read as a byte, so that a corrupt image cannot make an invalid bool.
+template <>
+struct Snapshot_Codec<bool> {
+	static const bool supported = true;
+	static size_t write(const bool& value, char * out) {
+		if (out != nullptr) {
+			*out = value ? 1 : 0;
+		}
+		return 1;
+	}
+	static size_t read(bool& value, const char * data, size_t size) {
+		if (size < 1) {
+			return 0;
+		}
+		value = data[0] != 0;
+		return 1;
+	}
+};
+
+template <>
+struct Snapshot_Codec<std::string> {
+	static const bool supported = true;
+	static size_t write(const std::string& value, char * out) {
+		size_t n = write_snapshot_length(value.size(), out);
+		if (out != nullptr) {
+			memcpy(out + n, value.data(), value.size());
+		}
+		return n + value.size();
+	}
+	static size_t read(std::string& value, const char * data, size_t size) {
+		uint64_t length;
+		if (!read_snapshot_length(length, data, size) || length > size - sizeof(length)) {
+			return 0;
+		}
+		value.assign(data + sizeof(length), length);
+		return sizeof(length) + length;
+	}
+};
+
+// The characters are stored with their terminator, so a restored pointer
+// points straight into the image, which has to outlive it, just like argv.
+template <>
+struct Snapshot_Codec<const char *> {
+	static const bool supported = true;
+	static const uint64_t null_length = (uint64_t)-1;
+	static size_t write(const char * value, char * out) {
+		if (value == nullptr) {
+			return write_snapshot_length(null_length, out);
+		}
+		size_t length = strlen(value);
+		size_t n = write_snapshot_length(length, out);
+		if (out != nullptr) {
+			memcpy(out + n, value, length + 1);
+		}
+		return n + length + 1;
+	}
+	static size_t read(const char *& value, const char * data, size_t size) {
+		uint64_t length;
+		if (!read_snapshot_length(length, data, size)) {
+			return 0;
+		}
+		if (length == null_length) {
+			value = nullptr;
+			return sizeof(length);
+		}
+		if (length >= size - sizeof(length) || data[sizeof(length) + length] != '\0') {
+			return 0;
+		}
+		value = data + sizeof(length);
+		return sizeof(length) + length + 1;
+	}
+};
+
+template <>
+struct Snapshot_Codec<Arg_View> {
+	static const bool supported = true;
+	static size_t write(const Arg_View& value, char * out) {
+		size_t n = write_snapshot_length(value.length, out);
+		if (out != nullptr) {
+			memcpy(out + n, value.data, value.length);
+			out[n + value.length] = '\0';
+		}
+		return n + value.length + 1;
+	}
+	static size_t read(Arg_View& value, const char * data, size_t size) {
+		uint64_t length;
+		if (!read_snapshot_length(length, data, size) || length >= size - sizeof(length)) {
+			return 0;
+		}
+		value = Arg_View(data + sizeof(length), length);
+		return sizeof(length) + length + 1;
+	}
+};
+
+template <typename T>
+struct Snapshot_Codec<std::vector<T>> {
+	static const bool supported = Snapshot_Codec<T>::supported;
+	static size_t write(const std::vector<T>& value, char * out) {
+		if (!supported) {
+			return 0;
+		}
+		size_t n = write_snapshot_length(value.size(), out);
+		for (size_t i = 0; i < value.size(); i++) {
+			n += Snapshot_Codec<T>::write(value[i], out == nullptr ? nullptr : out + n);
+		}
+		return n;
+	}
+	static size_t read(std::vector<T>& value, const char * data, size_t size) {
+		uint64_t count;
+		if (!read_snapshot_length(count, data, size)) {
+			return 0;
+		}
+		size_t n = sizeof(count);
+		value.clear();
+		// Every element takes at least one byte, which bounds a corrupt count.
+		value.reserve(count < size ? count : size);
+		for (uint64_t i = 0; i < count; i++) {
+			T element;
+			size_t used = Snapshot_Codec<T>::read(element, data + n, size - n);
+			if (used == 0) {
+				return 0;
+			}
+			value.push_back(element);
+			n += used;
+		}
+		return n;
+	}
+};
+
+// A snapshot image mapped read-only from a file descriptor, such as a file,
+// a memfd or a shm_open segment written with Parser::write_snapshot. Strings
+// restored as const char * or Arg_View point into the mapping, so it has to
+// outlive them.
+class Mapped_Snapshot {
+private:
+	void * memory;
+	size_t length;
+public:
+	explicit Mapped_Snapshot(int fd);
+	~Mapped_Snapshot();
+	Mapped_Snapshot(const Mapped_Snapshot&) = delete;
+	Mapped_Snapshot& operator=(const Mapped_Snapshot&) = delete;
+	const char * data() const;
+	size_t size() const;
+};
+
+inline Mapped_Snapshot::Mapped_Snapshot(int fd) : memory(nullptr), length(0) {
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		raise_error<std::runtime_error>("Could not find the size of the snapshot.");
+	}
+	length = info.st_size;
+	if (length == 0) {
+		return;
+	}
+	memory = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+	if (memory == MAP_FAILED) {
+		memory = nullptr;
+		raise_error<std::runtime_error>("Could not map the snapshot.");
+	}
+}
+
+inline Mapped_Snapshot::~Mapped_Snapshot() {
+	if (memory != nullptr) {
+		munmap(memory, length);
+	}
+}
+
+inline const char * Mapped_Snapshot::data() const {
+	return (const char *)memory;
+}
+
+inline size_t Mapped_Snapshot::size() const {
+	return length;
+}
+
+}
+#endif
@@ -0,0 +1,338 @@
+#ifndef STATIC_PARSER_H
+#define STATIC_PARSER_H
+#include "args_parser_templates.h"
+#include "template_definitions.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace cli {
+
+// One alias of an option whose schema is fixed at compile time. option is the
+// index of the binding the alias refers to.
+struct Static_Alias {
+	const char * name;
+	size_t length;
+	unsigned option;
+};
+
+template <size_t N>
+constexpr Static_Alias static_alias(const char (&name)[N], unsigned option) {
+	return Static_Alias{ name, N - 1, option };
+}
+
+template <typename T, size_t N>
+constexpr size_t static_size(const T (&)[N]) {
+	return N;
+}
+
+////////////////////////Compile Time Schema Checks///////////////////////
+
+constexpr bool static_chars_equal(const char * a, const char * b, size_t length) {
+	return length == 0 || (*a == *b && static_chars_equal(a + 1, b + 1, length - 1));
+}
+
+constexpr bool static_aliases_equal(const Static_Alias& a, const Static_Alias& b) {
+	return a.length == b.length && static_chars_equal(a.name, b.name, a.length);
+}
+
+constexpr bool static_alias_differs_from_rest(const Static_Alias * aliases, size_t n, size_t i, size_t j) {
+	return j >= n || (!static_aliases_equal(aliases[i], aliases[j]) && static_alias_differs_from_rest(aliases, n, i, j + 1));
+}
+
+constexpr bool static_aliases_unique(const Static_Alias * aliases, size_t n, size_t i = 0) {
+	return i >= n || (static_alias_differs_from_rest(aliases, n, i, i + 1) && static_aliases_unique(aliases, n, i + 1));
+}
+
+constexpr bool static_options_in_range(const Static_Alias * aliases, size_t n, size_t num_options) {
+	return n == 0 || (aliases[0].option < num_options && static_options_in_range(aliases + 1, n - 1, num_options));
+}
+
+////////////////////////////////Bindings/////////////////////////////////
+
+// Converts its argument with the same Var<T> specializations the runtime
+// Parser uses, so user defined conversions work with both.
+template <typename T>
+struct Static_Arg {
+	static constexpr bool takes_args = true;
+	T * var;
+	void set(const char * b_v) const {
+		Var<T> temp_var(*var, {}, true);
+		temp_var.set_base_variable(b_v);
+	}
+};
+
+template <typename T>
+struct Static_Value {
+	static constexpr bool takes_args = false;
+	T * var;
+	T value;
+	void set(const char * b_v) const {
+		(void)b_v;
+		*var = value;
+	}
+};
+
+template <typename T>
+struct Static_Vector {
+	static constexpr bool takes_args = true;
+	std::vector<T> * var;
+	void set(const char * b_v) const {
+		Vector<T> temp_vector(*var, {});
+		temp_vector.set_base_variable(b_v);
+	}
+};
+
+// Every occurrence adds one, so "-vvv" and "-v -v -v" both count to three.
+template <typename T>
+struct Static_Count {
+	static constexpr bool takes_args = false;
+	T * var;
+	void set(const char * b_v) const {
+		(void)b_v;
+		++*var;
+	}
+};
+
+template <typename T>
+struct Static_Sum {
+	static constexpr bool takes_args = true;
+	T * var;
+	void set(const char * b_v) const {
+		Sum<T> temp_sum(*var, {});
+		temp_sum.set_base_variable(b_v);
+	}
+};
+
+// One flag of a word of packed boolean flags.
+template <typename T>
+struct Static_Bits {
+	static constexpr bool takes_args = false;
+	T * word;
+	T mask;
+	void set(const char * b_v) const {
+		(void)b_v;
+		*word |= mask;
+	}
+};
+
+template <typename T>
+Static_Arg<T> static_arg(T& var) {
+	return Static_Arg<T>{ &var };
+}
+
+template <typename T>
+Static_Value<T> static_value(T& var, T value) {
+	return Static_Value<T>{ &var, value };
+}
+
+template <typename T>
+Static_Vector<T> static_vector(std::vector<T>& var) {
+	return Static_Vector<T>{ &var };
+}
+
+template <typename T>
+Static_Count<T> static_count(T& var) {
+	return Static_Count<T>{ &var };
+}
+
+template <typename T>
+Static_Sum<T> static_sum(T& var) {
+	return Static_Sum<T>{ &var };
+}
+
+template <typename T>
+Static_Bits<T> static_bits(T& word, T mask) {
+	return Static_Bits<T>{ &word, mask };
+}
+
+///////////////////////////////Dispatching///////////////////////////////
+
+// Unrolled at compile time into a chain of length and byte comparisons
+// against the constant aliases.
+template <size_t N, const Static_Alias (&Aliases)[N], size_t I = 0>
+struct Static_Lookup {
+	static int find(const char * flag, size_t length) {
+		if (length == Aliases[I].length && memcmp(flag, Aliases[I].name, Aliases[I].length) == 0) {
+			return Aliases[I].option;
+		}
+		return Static_Lookup<N, Aliases, I + 1>::find(flag, length);
+	}
+};
+
+template <size_t N, const Static_Alias (&Aliases)[N]>
+struct Static_Lookup<N, Aliases, N> {
+	static int find(const char * flag, size_t length) {
+		(void)flag;
+		(void)length;
+		return -1;
+	}
+};
+
+template <typename Tuple, size_t I = std::tuple_size<Tuple>::value>
+struct Static_Dispatch {
+	static bool takes_args(unsigned option) {
+		typedef typename std::tuple_element<I - 1, Tuple>::type binding;
+		return option == I - 1 ? binding::takes_args : Static_Dispatch<Tuple, I - 1>::takes_args(option);
+	}
+	static void set(const Tuple& bindings, unsigned option, const char * b_v) {
+		if (option == I - 1) {
+			std::get<I - 1>(bindings).set(b_v);
+		} else {
+			Static_Dispatch<Tuple, I - 1>::set(bindings, option, b_v);
+		}
+	}
+};
+
+template <typename Tuple>
+struct Static_Dispatch<Tuple, 0> {
+	static bool takes_args(unsigned option) {
+		(void)option;
+		return false;
+	}
+	static void set(const Tuple& bindings, unsigned option, const char * b_v) {
+		(void)bindings;
+		(void)option;
+		(void)b_v;
+	}
+};
+
+/////////////////////////////Static_Parser///////////////////////////////
+
+// A parser whose aliases, argument requirements and conversions are all fixed
+// at compile time. Constructing one does no work, and parse allocates nothing
+// unless a binding does, such as a Static_Vector or a std::string.
+template <size_t N, const Static_Alias (&Aliases)[N], typename... Bindings>
+class Static_Parser {
+	static_assert(static_aliases_unique(Aliases, N), "Flag already used in static schema.");
+	static_assert(static_options_in_range(Aliases, N, sizeof...(Bindings)), "Static alias refers to an option that has no binding.");
+private:
+	typedef std::tuple<Bindings...> binding_tuple;
+	binding_tuple bindings;
+private:
+	int find_option(const char * error_message, const char * flag, size_t length);
+	bool takes_args(int option);
+	void set(int option, const char * b_v);
+	void throw_error(const char * error_message, const char * flag, size_t length);
+
+	void long_option_handling(char * flag);
+	void short_option_handling(int argc, char ** argv, int& i);
+public:
+	Static_Parser(Bindings... b) : bindings(b...) {}
+	int parse(int argc, char ** argv);
+};
+
+template <size_t N, const Static_Alias (&Aliases)[N], typename... Bindings>
+Static_Parser<N, Aliases, Bindings...> make_static_parser(Bindings... b) {
+	return Static_Parser<N, Aliases, Bindings...>(b...);
+}
+
+template <size_t N, const Static_Alias (&Aliases)[N], typename... Bindings>
+inline void Static_Parser<N, Aliases, Bindings...>::throw_error(const char * error_message, const char * flag, size_t length) {
+	std::string error_message_buffer;
+	error_message_buffer.reserve(1024);
+	error_message_buffer += error_message;
+	error_message_buffer.append(flag, length);
+	raise_error<std::invalid_argument>(error_message_buffer);
+}
+
+template <size_t N, const Static_Alias (&Aliases)[N], typename... Bindings>
+inline int Static_Parser<N, Aliases, Bindings...>::find_option(const char * error_message, const char * flag, size_t length) {
+	int option = Static_Lookup<N, Aliases>::find(flag, length);
+	if (option < 0) {
+		throw_error(error_message, flag, length);
+	}
+	return option;
+}
+
+template <size_t N, const Static_Alias (&Aliases)[N], typename... Bindings>
+inline bool Static_Parser<N, Aliases, Bindings...>::takes_args(int option) {
+	return Static_Dispatch<binding_tuple>::takes_args(option);
+}
+
+template <size_t N, const Static_Alias (&Aliases)[N], typename... Bindings>
+inline void Static_Parser<N, Aliases, Bindings...>::set(int option, const char * b_v) {
+	Static_Dispatch<binding_tuple>::set(bindings, option, b_v);
+}
+
+// Moves the non-options, in order, to argv[1] onwards and returns how many
+// there are, so nothing has to be allocated to return them.
+template <size_t N, const Static_Alias (&Aliases)[N], typename... Bindings>
+inline int Static_Parser<N, Aliases, Bindings...>::parse(int argc, char ** argv) {
+	int num_non_options = 0;
+	for (int i = 1; i < argc; i++) {
+		char * cur = argv[i];
+		// case: non-option
+		if (cur[0] != '-') {
+			argv[1 + num_non_options++] = cur;
+		// case: -- and all arguments are non-options
+		} else if (cur[1] == '-' && cur[2] == '\0') {
+			for (i++; i < argc; i++) {
+				argv[1 + num_non_options++] = argv[i];
+			}
+			break;
+		// case: --long-option
+		} else if (cur[1] == '-') {
+			long_option_handling(cur + 2);
+		// case: -
+		} else if (cur[1] == '\0') {
+			set(find_option("Unrecognized Option: ", "-", 1), cur);
+		} else {
+			short_option_handling(argc, argv, i);
+		}
+	}
+	return num_non_options;
+}
+
+template <size_t N, const Static_Alias (&Aliases)[N], typename... Bindings>
+inline void Static_Parser<N, Aliases, Bindings...>::long_option_handling(char * flag) {
+	size_t length = strcspn(flag, "=");
+	int option = find_option("Unrecognized Option: --", flag, length);
+	// case: --long-option=value
+	if (flag[length] == '=') {
+		if (!takes_args(option)) {
+			throw_error("Option does not take arguments: --", flag, length);
+		}
+		set(option, flag + length + 1);
+	// case: --long-option
+	} else if (takes_args(option)) {
+		throw_error("Option requires arguments: --", flag, length);
+	} else {
+		set(option, flag);
+	}
+}
+
+template <size_t N, const Static_Alias (&Aliases)[N], typename... Bindings>
+inline void Static_Parser<N, Aliases, Bindings...>::short_option_handling(int argc, char ** argv, int& i) {
+	char * flag = argv[i] + 1;
+	int option = find_option("Unrecognized Option: -", flag, 1);
+	if (takes_args(option)) {
+		// case: -o value
+		if (flag[1] == '\0' && i + 1 < argc) {
+			i++;
+			set(option, argv[i]);
+		// case: -oValue, or a trailing -o, which is set from an empty value
+		// just like with Parser
+		} else {
+			set(option, flag + 1);
+		}
+		return;
+	}
+	// case: -abc, -vvv, or -abcf value
+	for (size_t j = 0; flag[j] != '\0'; j++) {
+		option = find_option("Unrecognized Option: -", flag + j, 1);
+		if (!takes_args(option)) {
+			set(option, flag + j);
+		} else if (flag[j + 1] == '\0' && i + 1 < argc) {
+			i++;
+			set(option, argv[i]);
+		} else {
+			throw_error("Option requires arguments: -", flag + j, 1);
+		}
+	}
+}
+
+}
+#endif
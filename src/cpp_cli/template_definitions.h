@@ -1,50 +1,138 @@
 #ifndef TEMPLATE_DEFINITIONS_H
 #define TEMPLATE_DEFINITIONS_H
 #include "args_parser_templates.h"
+#include "snapshot.h"
+#include "argv_writer.h"
+#include <cstdio>
 #include <cstdlib>
 #include <stdexcept>
 
 namespace cli {
+#ifdef CPP_CLI_DEFINITIONS
 /////////////////////CLI_Interface Definitions////////////////////
 
-inline CLI_Interface::CLI_Interface(void * b_v, std::vector<const char *> a, bool ta, const char * hm) : takes_args_var(ta), base_variable(b_v), aliases(a), help_message(hm) {}
+CPP_CLI_INLINE CLI_Interface::CLI_Interface(void * b_v, std::vector<const char *> a, bool ta, const char * hm) : takes_args_var(ta), base_variable(b_v), aliases(std::move(a)), help_message(hm) {}
 
-inline const std::vector<const char *>& CLI_Interface::get_aliases() const {
+CPP_CLI_INLINE const std::vector<const char *>& CLI_Interface::get_aliases() const {
 	return aliases;
 }
 
-inline bool CLI_Interface::takes_args() const {
+CPP_CLI_INLINE bool CLI_Interface::takes_args() const {
 	return takes_args_var;
 }
 
-inline bool CLI_Interface::ignored() const {
+CPP_CLI_INLINE bool CLI_Interface::ignored() const {
 	return base_variable == nullptr;
 }
 
-inline const char * CLI_Interface::get_help_message() const {
+CPP_CLI_INLINE const char * CLI_Interface::get_help_message() const {
 	return help_message;
 }
 
+CPP_CLI_INLINE void CLI_Interface::set_repetitions(Arg_View alias, size_t count) {
+	(void)alias;
+	// The count is formatted on the stack so that nothing is allocated.
+	char repetitions[24];
+	snprintf(repetitions, sizeof(repetitions), "%zu", count);
+	set_base_variable(repetitions);
+}
+
+CPP_CLI_INLINE bool CLI_Interface::appends() const {
+	return false;
+}
+
+CPP_CLI_INLINE bool CLI_Interface::try_set_base_variable(const char * b_v) {
+	set_base_variable(b_v);
+	return true;
+}
+
+CPP_CLI_INLINE std::string CLI_Interface::invalid_value_message(Arg_View value) const {
+	std::string error_message;
+	error_message.reserve(128);
+	error_message += "Invalid value for ";
+	error_message += aliases.empty() ? "" : aliases[0];
+	error_message += ": ";
+	error_message.append(value.data, value.length);
+	return error_message;
+}
+
+CPP_CLI_INLINE size_t CLI_Interface::append_slots(size_t n) {
+	(void)n;
+	raise_error<std::logic_error>("This option does not append its values.");
+}
+
+CPP_CLI_INLINE void CLI_Interface::set_slot(size_t slot, const char * b_v) {
+	(void)slot;
+	(void)b_v;
+	raise_error<std::logic_error>("This option does not append its values.");
+}
+
+CPP_CLI_INLINE bool CLI_Interface::converts_in_parallel() const {
+	return true;
+}
+
+CPP_CLI_INLINE bool CLI_Interface::run_action(Parser& p) {
+	(void)p;
+	return false;
+}
+
+CPP_CLI_INLINE size_t CLI_Interface::write_snapshot(char * out) const {
+	(void)out;
+	return 0;
+}
+
+CPP_CLI_INLINE bool CLI_Interface::read_snapshot(const char * data, size_t size) {
+	(void)data;
+	return size == 0;
+}
+
+CPP_CLI_INLINE void CLI_Interface::write_arguments(Argv_Writer& writer) const {
+	(void)writer;
+}
+#endif
+
 //////////////////////////Var Definitions/////////////////////////
 
 template<typename T>
-inline Var<T>::Var(T & b_v, std::vector<const char *> a, bool ta, const char * hm) : CLI_Interface(&b_v, a, ta, hm) {}
+inline Var<T>::Var(T & b_v, std::vector<const char *> a, bool ta, const char * hm) : CLI_Interface(&b_v, std::move(a), ta, hm) {}
 
 template<typename T>
-inline Var<T>::Var(T * b_v, std::vector<const char *> a, bool ta, const char * hm) : CLI_Interface(b_v, a, ta, hm) {}
+inline Var<T>::Var(T * b_v, std::vector<const char *> a, bool ta, const char * hm) : CLI_Interface(b_v, std::move(a), ta, hm) {}
 
 template<typename T>
 inline void Var<T>::set_base_variable(const char * b_v) {
 	*(T *)base_variable = b_v;
 }
 
+template<typename T>
+inline size_t Var<T>::write_snapshot(char * out) const {
+	return Snapshot_Codec<T>::write(*(const T *)base_variable, out);
+}
+
+template<typename T>
+inline bool Var<T>::read_snapshot(const char * data, size_t size) {
+	return Snapshot_Codec<T>::read(*(T *)base_variable, data, size) == size;
+}
+
+// An option that does not take arguments is set to the number of times its
+// flag is repeated, so it is written the same way.
+template<typename T>
+inline void Var<T>::write_arguments(Argv_Writer& writer) const {
+	const T& variable = *(const T *)base_variable;
+	if (takes_args_var) {
+		write_flag_with_value(writer, aliases, variable);
+	} else {
+		writer.repeated_flag(aliases, argument_repetitions(variable));
+	}
+}
+
 ///////////////////////Value Definitions//////////////////////
 
 template<typename T>
-inline Value<T>::Value(T & b_v, std::vector<const char *>a, T v, const char * hm) : CLI_Interface(&b_v, a, false, hm), value(v) {}
+inline Value<T>::Value(T & b_v, std::vector<const char *>a, T v, const char * hm) : CLI_Interface(&b_v, std::move(a), false, hm), value(v) {}
 
 template<typename T>
-inline Value<T>::Value(T * b_v, std::vector<const char *>a, T v, const char * hm) : CLI_Interface(b_v, a, false, hm), value(v) {}
+inline Value<T>::Value(T * b_v, std::vector<const char *>a, T v, const char * hm) : CLI_Interface(b_v, std::move(a), false, hm), value(v) {}
 
 template<typename T>
 inline void Value<T>::set_base_variable(const char * b_v) {
@@ -52,13 +140,163 @@ inline void Value<T>::set_base_variable(const char * b_v) {
 	*(T*)base_variable = value;
 }
 
+template<typename T>
+inline size_t Value<T>::write_snapshot(char * out) const {
+	return Snapshot_Codec<T>::write(*(const T *)base_variable, out);
+}
+
+template<typename T>
+inline bool Value<T>::read_snapshot(const char * data, size_t size) {
+	return Snapshot_Codec<T>::read(*(T *)base_variable, data, size) == size;
+}
+
+template<typename T>
+inline void Value<T>::write_arguments(Argv_Writer& writer) const {
+	if (argument_values_equal(*(const T *)base_variable, value, 0)) {
+		writer.flag(aliases);
+	}
+}
+
+//////////////////////Count Definitions//////////////////////
+
+template<typename T>
+inline Count<T>::Count(T & b_v, std::vector<const char *> a, const char * hm) : CLI_Interface(&b_v, std::move(a), false, hm) {}
+
+template<typename T>
+inline void Count<T>::set_base_variable(const char * b_v) {
+	(void)b_v;
+	++*(T *)base_variable;
+}
+
+template<typename T>
+inline void Count<T>::set_repetitions(Arg_View alias, size_t count) {
+	(void)alias;
+	*(T *)base_variable += (T)count;
+}
+
+template<typename T>
+inline size_t Count<T>::write_snapshot(char * out) const {
+	return Snapshot_Codec<T>::write(*(const T *)base_variable, out);
+}
+
+template<typename T>
+inline bool Count<T>::read_snapshot(const char * data, size_t size) {
+	return Snapshot_Codec<T>::read(*(T *)base_variable, data, size) == size;
+}
+
+// "-vvv" if there is a short alias, otherwise the long one repeated.
+template<typename T>
+inline void Count<T>::write_arguments(Argv_Writer& writer) const {
+	size_t count = argument_repetitions(*(const T *)base_variable);
+	if (!writer.repeated_flag(aliases, count)) {
+		for (size_t i = 0; i < count && writer.flag(aliases); i++) {}
+	}
+}
+
+///////////////////////Sum Definitions///////////////////////
+
+template<typename T>
+inline Sum<T>::Sum(T & b_v, std::vector<const char *> a, const char * hm) : CLI_Interface(&b_v, std::move(a), true, hm) {}
+
+template<typename T>
+inline void Sum<T>::set_base_variable(const char * b_v) {
+	T value = T();
+	Var<T> temp_var(value, {}, true);
+	temp_var.set_base_variable(b_v);
+	*(T *)base_variable += value;
+}
+
+template<typename T>
+inline size_t Sum<T>::write_snapshot(char * out) const {
+	return Snapshot_Codec<T>::write(*(const T *)base_variable, out);
+}
+
+template<typename T>
+inline bool Sum<T>::read_snapshot(const char * data, size_t size) {
+	return Snapshot_Codec<T>::read(*(T *)base_variable, data, size) == size;
+}
+
+// The total is written as a single value.
+template<typename T>
+inline void Sum<T>::write_arguments(Argv_Writer& writer) const {
+	write_flag_with_value(writer, aliases, *(const T *)base_variable);
+}
+
+///////////////////////Bits Definitions///////////////////////
+
+template<typename T>
+inline Bits<T>::Bits(T & b_v, std::vector<std::pair<const char *, T>> b, const char * hm) : CLI_Interface(&b_v, bit_aliases(b), false, hm) {
+	masks.reserve(b.size());
+	for (size_t i = 0; i < b.size(); i++) {
+		masks.insert(Arg_View(b[i].first), b[i].second);
+	}
+}
+
+template<typename T>
+inline std::vector<const char *> Bits<T>::bit_aliases(const std::vector<std::pair<const char *, T>>& b) {
+	std::vector<const char *> a;
+	a.reserve(b.size());
+	for (size_t i = 0; i < b.size(); i++) {
+		a.push_back(b[i].first);
+	}
+	return a;
+}
+
+// An option that takes no arguments is given the alias it was found by.
+template<typename T>
+inline void Bits<T>::set_base_variable(const char * b_v) {
+	const T * mask = masks.find(Arg_View(b_v));
+	if (mask != nullptr) {
+		*(T *)base_variable |= *mask;
+	}
+}
+
+template<typename T>
+inline void Bits<T>::set_repetitions(Arg_View alias, size_t count) {
+	(void)count;
+	const T * mask = masks.find(alias);
+	if (mask != nullptr) {
+		*(T *)base_variable |= *mask;
+	}
+}
+
+template<typename T>
+inline size_t Bits<T>::write_snapshot(char * out) const {
+	return Snapshot_Codec<T>::write(*(const T *)base_variable, out);
+}
+
+template<typename T>
+inline bool Bits<T>::read_snapshot(const char * data, size_t size) {
+	return Snapshot_Codec<T>::read(*(T *)base_variable, data, size) == size;
+}
+
+// Every alias whose bits are all set, in the order they were given. An alias
+// whose bits are already covered by the ones written before it is skipped.
+template<typename T>
+inline void Bits<T>::write_arguments(Argv_Writer& writer) const {
+	T word = *(const T *)base_variable;
+	T written = 0;
+	for (size_t i = 0; i < aliases.size(); i++) {
+		T mask = 0;
+		for (size_t j = 0; j < masks.size(); j++) {
+			if (masks[j].first == Arg_View(aliases[i])) {
+				mask = masks[j].second;
+			}
+		}
+		if (mask != 0 && (word & mask) == mask && (written & mask) != mask) {
+			writer.flag_alias(aliases[i]);
+			written |= mask;
+		}
+	}
+}
+
 //////////////////////Vector Definitions//////////////////////
 
 template<typename T>
-inline Vector<T>::Vector(std::vector<T> & b_v, std::vector<const char *>a, const char * hm) : CLI_Interface(&b_v, a, true, hm) {}
+inline Vector<T>::Vector(std::vector<T> & b_v, std::vector<const char *>a, const char * hm) : CLI_Interface(&b_v, std::move(a), true, hm) {}
 
 template<typename T>
-inline Vector<T>::Vector(std::vector<T> * b_v, std::vector<const char *>a, const char * hm) : CLI_Interface(b_v, a, true, hm) {}
+inline Vector<T>::Vector(std::vector<T> * b_v, std::vector<const char *>a, const char * hm) : CLI_Interface(b_v, std::move(a), true, hm) {}
 	
 template<typename T>
 inline void Vector<T>::set_base_variable(const char * b_v) {
@@ -69,13 +307,198 @@ inline void Vector<T>::set_base_variable(const char * b_v) {
 	base_variable_vector.push_back(temp);
 }
 
+template<typename T>
+inline bool Vector<T>::appends() const {
+	return true;
+}
+
+template<typename T>
+inline size_t Vector<T>::append_slots(size_t n) {
+	std::vector<T>& base_variable_vector = *(std::vector<T> *)base_variable;
+	size_t first = base_variable_vector.size();
+	base_variable_vector.resize(first + n);
+	return first;
+}
+
+template<typename T>
+inline void Vector<T>::set_slot(size_t slot, const char * b_v) {
+	std::vector<T>& base_variable_vector = *(std::vector<T> *)base_variable;
+	Var<T> temp_var(base_variable_vector[slot], {}, true);
+	temp_var.set_base_variable(b_v);
+}
+
+template<typename T>
+inline size_t Vector<T>::write_snapshot(char * out) const {
+	return Snapshot_Codec<std::vector<T>>::write(*(const std::vector<T> *)base_variable, out);
+}
+
+template<typename T>
+inline bool Vector<T>::read_snapshot(const char * data, size_t size) {
+	return Snapshot_Codec<std::vector<T>>::read(*(std::vector<T> *)base_variable, data, size) == size;
+}
+
+template<typename T>
+inline void Vector<T>::write_arguments(Argv_Writer& writer) const {
+	const std::vector<T>& base_variable_vector = *(const std::vector<T> *)base_variable;
+	for (size_t i = 0; i < base_variable_vector.size(); i++) {
+		write_flag_with_value<T>(writer, aliases, base_variable_vector[i]);
+	}
+}
+
+//////////////////////Choice Definitions//////////////////////
+
+template<typename T>
+inline Choice<T>::Choice(T & b_v, std::vector<const char *> a, std::vector<std::pair<const char *, T>> c, const char * hm) : CLI_Interface(&b_v, std::move(a), true, hm) {
+	fill_choices(c);
+}
+
+template<typename T>
+inline Choice<T>::Choice(T * b_v, std::vector<const char *> a, std::vector<std::pair<const char *, T>> c, const char * hm) : CLI_Interface(b_v, std::move(a), true, hm) {
+	fill_choices(c);
+}
+
+template<typename T>
+inline void Choice<T>::fill_choices(const std::vector<std::pair<const char *, T>>& c) {
+	choices.reserve(c.size());
+	for (size_t i = 0; i < c.size(); i++) {
+		choices.insert(Arg_View(c[i].first), c[i].second);
+		if (i != 0) {
+			valid_values += ", ";
+		}
+		valid_values += c[i].first;
+	}
+	if (help_message[0] != '`') {
+		choice_help_message = help_message;
+		if (!choice_help_message.empty()) {
+			choice_help_message += " ";
+		}
+		choice_help_message += "Valid values: ";
+		choice_help_message += valid_values;
+		help_message = choice_help_message.c_str();
+	}
+}
+
+template<typename T>
+inline void Choice<T>::set_base_variable(const char * b_v) {
+	if (!try_set_base_variable(b_v)) {
+		raise_error<std::invalid_argument>(invalid_value_message(Arg_View(b_v)));
+	}
+}
+
+template<typename T>
+inline bool Choice<T>::try_set_base_variable(const char * b_v) {
+	const T * choice = choices.find(Arg_View(b_v));
+	if (choice == nullptr) {
+		return false;
+	}
+	*(T *)base_variable = *choice;
+	return true;
+}
+
+template<typename T>
+inline std::string Choice<T>::invalid_value_message(Arg_View value) const {
+	std::string error_message;
+	error_message.reserve(256);
+	error_message += "Invalid value for ";
+	error_message += aliases[0];
+	error_message += ": ";
+	error_message.append(value.data, value.length);
+	error_message += ". Valid values: ";
+	error_message += valid_values;
+	return error_message;
+}
+
+template<typename T>
+inline size_t Choice<T>::write_snapshot(char * out) const {
+	return Snapshot_Codec<T>::write(*(const T *)base_variable, out);
+}
+
+template<typename T>
+inline bool Choice<T>::read_snapshot(const char * data, size_t size) {
+	return Snapshot_Codec<T>::read(*(T *)base_variable, data, size) == size;
+}
+
+// Writes the name of the current value, if it has one.
+template<typename T>
+inline void Choice<T>::write_arguments(Argv_Writer& writer) const {
+	for (size_t i = 0; i < choices.size(); i++) {
+		if (argument_values_equal(choices[i].second, *(const T *)base_variable, 0)) {
+			writer.flag_with_value(aliases, choices[i].first);
+			return;
+		}
+	}
+}
+
+// The conversions for the built in types, which programs using the compiled
+// library only see declared.
+template<>
+void Var<int>::set_base_variable(const char * b_v);
+template<>
+void Var<unsigned int>::set_base_variable(const char * b_v);
+template<>
+void Var<long>::set_base_variable(const char * b_v);
+template<>
+void Var<unsigned long>::set_base_variable(const char * b_v);
+template<>
+void Var<long long>::set_base_variable(const char * b_v);
+template<>
+void Var<unsigned long long>::set_base_variable(const char * b_v);
+template<>
+void Var<float>::set_base_variable(const char * b_v);
+template<>
+void Var<double>::set_base_variable(const char * b_v);
+template<>
+void Var<long double>::set_base_variable(const char * b_v);
+template<>
+void Vector<const char *>::set_base_variable(const char * b_v);
+template<>
+void Vector<char *>::set_base_variable(const char * b_v);
+template<>
+bool Vector<bool>::appends() const;
+template<>
+void Vector<bool>::set_slot(size_t slot, const char * b_v);
+template<>
+bool Vector<char>::appends() const;
+template<>
+bool Vector<char *>::appends() const;
+template<>
+void Vector<char *>::set_slot(size_t slot, const char * b_v);
+template<>
+void Vector<char>::set_base_variable(const char * b_v);
+template<>
+void Vector<char>::write_arguments(Argv_Writer& writer) const;
+
+#ifdef CPP_CLI_DEFINITIONS
+///////////////////////Sink Definitions///////////////////////
+
+// The base variable only has to be set so that the option is not ignored.
+CPP_CLI_INLINE Sink::Sink(argument_sink s, void * s_d, std::vector<const char *> a, const char * hm) : CLI_Interface(&sink_data, std::move(a), true, hm), sink(s), sink_data(s_d) {}
+
+CPP_CLI_INLINE void Sink::set_base_variable(const char * b_v) {
+	sink(b_v, sink_data);
+}
+
+///////////////////////Action Definitions///////////////////////
+
+CPP_CLI_INLINE Action::Action(action_func f, void * a_d, std::vector<const char *> a, const char * hm) : CLI_Interface(&action_data, std::move(a), false, hm), action(f), action_data(a_d) {}
+
+// The function only runs through run_action, which the parser calls instead.
+CPP_CLI_INLINE void Action::set_base_variable(const char * b_v) {
+	(void)b_v;
+}
+
+CPP_CLI_INLINE bool Action::run_action(Parser& p) {
+	action(p, action_data);
+	return true;
+}
+
 /////////////////////////Template Specializations//////////////////////////
 
-inline Var<char>::Var(char * b_v, std::vector<const char *> a, bool ta, int b_s, const char * hm) : CLI_Interface(b_v, a, ta, hm), buffer_size(b_s) {}
+CPP_CLI_INLINE Var<char>::Var(char * b_v, std::vector<const char *> a, bool ta, int b_s, const char * hm) : CLI_Interface(b_v, std::move(a), ta, hm), buffer_size(b_s) {}
 
-inline Var<char>::Var(char & b_v, std::vector<const char *> a, bool ta, const char * hm) : CLI_Interface(&b_v, a, ta, hm), buffer_size(1) {}
+CPP_CLI_INLINE Var<char>::Var(char & b_v, std::vector<const char *> a, bool ta, const char * hm) : CLI_Interface(&b_v, std::move(a), ta, hm), buffer_size(1) {}
 
-inline void Var<char>::set_base_variable(const char * b_v) {
+CPP_CLI_INLINE void Var<char>::set_base_variable(const char * b_v) {
 	char * base_variable_string = (char *)base_variable;
 	if (buffer_size == 1) {
 		*base_variable_string = b_v[0];
@@ -90,74 +513,220 @@ inline void Var<char>::set_base_variable(const char * b_v) {
 	base_variable_string[i] = '\0';
 }
 
+// The characters are saved without the terminator and cut to the buffer
+// again when they are restored.
+CPP_CLI_INLINE size_t Var<char>::write_snapshot(char * out) const {
+	const char * base_variable_string = (const char *)base_variable;
+	size_t length = buffer_size == 1 ? 1 : strnlen(base_variable_string, buffer_size);
+	if (out != nullptr) {
+		memcpy(out, base_variable_string, length);
+	}
+	return length;
+}
+
+CPP_CLI_INLINE bool Var<char>::read_snapshot(const char * data, size_t size) {
+	char * base_variable_string = (char *)base_variable;
+	if (buffer_size == 1) {
+		if (size != 1) {
+			return false;
+		}
+		*base_variable_string = data[0];
+		return true;
+	}
+	size_t length = size < (size_t)buffer_size ? size : buffer_size - 1;
+	memcpy(base_variable_string, data, length);
+	base_variable_string[length] = '\0';
+	return true;
+}
+
+CPP_CLI_INLINE void Var<char>::write_arguments(Argv_Writer& writer) const {
+	const char * base_variable_string = (const char *)base_variable;
+	if (!takes_args_var) {
+		return;
+	}
+	if (buffer_size == 1) {
+		write_flag_with_value(writer, aliases, *base_variable_string);
+	} else {
+		writer.flag_with_value(aliases, Arg_View(base_variable_string, strnlen(base_variable_string, buffer_size)));
+	}
+}
+
 template<>
-inline void Var<int>::set_base_variable(const char * b_v) {
+CPP_CLI_INLINE void Var<int>::set_base_variable(const char * b_v) {
 	*(int *)base_variable = strtol(b_v, nullptr, 10);
 }
 
 template<>
-inline void Var<unsigned int>::set_base_variable(const char * b_v) {
+CPP_CLI_INLINE void Var<unsigned int>::set_base_variable(const char * b_v) {
 	*(unsigned int *)base_variable = strtoul(b_v, nullptr, 10);
 }
 
 template<>
-inline void Var<long>::set_base_variable(const char * b_v) {
+CPP_CLI_INLINE void Var<long>::set_base_variable(const char * b_v) {
 	*(long *)base_variable = strtol(b_v, nullptr, 10);
 }
 
 template<>
-inline void Var<unsigned long>::set_base_variable(const char * b_v) {
+CPP_CLI_INLINE void Var<unsigned long>::set_base_variable(const char * b_v) {
 	*(unsigned long *)base_variable = strtoul(b_v, nullptr, 10);
 }
 
 template<>
-inline void Var<long long>::set_base_variable(const char * b_v) {
+CPP_CLI_INLINE void Var<long long>::set_base_variable(const char * b_v) {
 	*(long long *)base_variable = strtoll(b_v, nullptr, 10);
 }
 
 template<>
-inline void Var<unsigned long long>::set_base_variable(const char * b_v) {
+CPP_CLI_INLINE void Var<unsigned long long>::set_base_variable(const char * b_v) {
 	*(unsigned long long *)base_variable = strtoull(b_v, nullptr, 10);
 }
 
 template<>
-inline void Var<float>::set_base_variable(const char * b_v) {
+CPP_CLI_INLINE void Var<float>::set_base_variable(const char * b_v) {
 	*(float *)base_variable = strtof(b_v, nullptr);
 }
 
 template<>
-inline void Var<double>::set_base_variable(const char * b_v) {
+CPP_CLI_INLINE void Var<double>::set_base_variable(const char * b_v) {
 	*(double *)base_variable = strtod(b_v, nullptr);
 }
 
 template<>
-inline void Var<long double>::set_base_variable(const char * b_v) {
+CPP_CLI_INLINE void Var<long double>::set_base_variable(const char * b_v) {
 	*(long double *)base_variable = strtold(b_v, nullptr);
 }
 
 template<>
-inline void Vector<const char *>::set_base_variable(const char * b_v) {
+CPP_CLI_INLINE void Vector<const char *>::set_base_variable(const char * b_v) {
 	std::vector<const char *>& base_variable_vector = *(std::vector<const char *>*)base_variable;
 	base_variable_vector.push_back(b_v);
 }
 
 template<>
-inline void Vector<char *>::set_base_variable(const char * b_v) {
+CPP_CLI_INLINE void Vector<char *>::set_base_variable(const char * b_v) {
 	(void)b_v;
 	const char * error_message = "Because the length of the char buffers in the vector cannot "
 	"be specified and you cannot set a char * to a const char *, you cannot use char "
 	"as an acceptable type for a Vector. Use const char *, std::string, or "
 	"another template overload.";
-	throw std::invalid_argument(error_message);
+	raise_error<std::invalid_argument>(error_message);
+}
+
+// The elements of a std::vector<bool> share bytes, so they cannot be set from
+// different threads, and a Vector<char> appends a variable number of elements.
+template<>
+CPP_CLI_INLINE bool Vector<bool>::appends() const {
+	return false;
+}
+
+template<>
+CPP_CLI_INLINE void Vector<bool>::set_slot(size_t slot, const char * b_v) {
+	std::vector<bool>& base_variable_vector = *(std::vector<bool> *)base_variable;
+	bool temp;
+	Var<bool> temp_var(temp, {}, true);
+	temp_var.set_base_variable(b_v);
+	base_variable_vector[slot] = temp;
+}
+
+template<>
+CPP_CLI_INLINE bool Vector<char>::appends() const {
+	return false;
 }
 
 template<>
-inline void Vector<char>::set_base_variable(const char * b_v) {
+CPP_CLI_INLINE bool Vector<char *>::appends() const {
+	return false;
+}
+
+template<>
+CPP_CLI_INLINE void Vector<char *>::set_slot(size_t slot, const char * b_v) {
+	(void)slot;
+	set_base_variable(b_v);
+}
+
+template<>
+CPP_CLI_INLINE void Vector<char>::set_base_variable(const char * b_v) {
 	std::vector<char>& base_variable_vector = *(std::vector<char>*)base_variable;
 	while (*b_v != '\0') {
 		base_variable_vector.push_back(*b_v);
 		b_v++;
 	}
 }
+
+// Every argument appends all of its characters, so they go back as one.
+template<>
+CPP_CLI_INLINE void Vector<char>::write_arguments(Argv_Writer& writer) const {
+	const std::vector<char>& base_variable_vector = *(const std::vector<char> *)base_variable;
+	if (!base_variable_vector.empty()) {
+		writer.flag_with_value(aliases, Arg_View(base_variable_vector.data(), base_variable_vector.size()));
+	}
+}
+#endif
+
+// The options for the built in types are instantiated once, in the compiled
+// library, instead of in every translation unit that uses them.
+#if defined(CPP_CLI_LIBRARY)
+#define CPP_CLI_INSTANTIATION template
+#elif defined(CPP_CLI_COMPILED)
+#define CPP_CLI_INSTANTIATION extern template
+#endif
+#ifdef CPP_CLI_INSTANTIATION
+CPP_CLI_INSTANTIATION class Var<bool>;
+CPP_CLI_INSTANTIATION class Var<int>;
+CPP_CLI_INSTANTIATION class Var<unsigned int>;
+CPP_CLI_INSTANTIATION class Var<long>;
+CPP_CLI_INSTANTIATION class Var<unsigned long>;
+CPP_CLI_INSTANTIATION class Var<long long>;
+CPP_CLI_INSTANTIATION class Var<unsigned long long>;
+CPP_CLI_INSTANTIATION class Var<float>;
+CPP_CLI_INSTANTIATION class Var<double>;
+CPP_CLI_INSTANTIATION class Var<long double>;
+CPP_CLI_INSTANTIATION class Var<std::string>;
+CPP_CLI_INSTANTIATION class Var<const char *>;
+CPP_CLI_INSTANTIATION class Vector<bool>;
+CPP_CLI_INSTANTIATION class Vector<char>;
+CPP_CLI_INSTANTIATION class Vector<int>;
+CPP_CLI_INSTANTIATION class Vector<unsigned int>;
+CPP_CLI_INSTANTIATION class Vector<long>;
+CPP_CLI_INSTANTIATION class Vector<unsigned long>;
+CPP_CLI_INSTANTIATION class Vector<long long>;
+CPP_CLI_INSTANTIATION class Vector<unsigned long long>;
+CPP_CLI_INSTANTIATION class Vector<float>;
+CPP_CLI_INSTANTIATION class Vector<double>;
+CPP_CLI_INSTANTIATION class Vector<long double>;
+CPP_CLI_INSTANTIATION class Vector<std::string>;
+CPP_CLI_INSTANTIATION class Vector<const char *>;
+CPP_CLI_INSTANTIATION class Value<bool>;
+CPP_CLI_INSTANTIATION class Value<int>;
+CPP_CLI_INSTANTIATION class Value<unsigned int>;
+CPP_CLI_INSTANTIATION class Value<long>;
+CPP_CLI_INSTANTIATION class Value<unsigned long>;
+CPP_CLI_INSTANTIATION class Value<long long>;
+CPP_CLI_INSTANTIATION class Value<unsigned long long>;
+CPP_CLI_INSTANTIATION class Value<float>;
+CPP_CLI_INSTANTIATION class Value<double>;
+CPP_CLI_INSTANTIATION class Value<long double>;
+CPP_CLI_INSTANTIATION class Value<std::string>;
+CPP_CLI_INSTANTIATION class Value<const char *>;
+CPP_CLI_INSTANTIATION class Count<int>;
+CPP_CLI_INSTANTIATION class Count<unsigned int>;
+CPP_CLI_INSTANTIATION class Count<long>;
+CPP_CLI_INSTANTIATION class Count<unsigned long>;
+CPP_CLI_INSTANTIATION class Count<long long>;
+CPP_CLI_INSTANTIATION class Count<unsigned long long>;
+CPP_CLI_INSTANTIATION class Sum<int>;
+CPP_CLI_INSTANTIATION class Sum<unsigned int>;
+CPP_CLI_INSTANTIATION class Sum<long>;
+CPP_CLI_INSTANTIATION class Sum<unsigned long>;
+CPP_CLI_INSTANTIATION class Sum<long long>;
+CPP_CLI_INSTANTIATION class Sum<unsigned long long>;
+CPP_CLI_INSTANTIATION class Sum<float>;
+CPP_CLI_INSTANTIATION class Sum<double>;
+CPP_CLI_INSTANTIATION class Sum<long double>;
+CPP_CLI_INSTANTIATION class Bits<unsigned int>;
+CPP_CLI_INSTANTIATION class Bits<unsigned long>;
+CPP_CLI_INSTANTIATION class Bits<unsigned long long>;
+CPP_CLI_INSTANTIATION class Choice<int>;
+#endif
 }
 #endif
@@ -1,38 +1,136 @@
 #ifndef WSpecialization_H
 #define WSpecialization_H
 #include "args_parser_templates.h"
-#include <unordered_map>
+#include "template_definitions.h"
+#include "arg_view.h"
+#include <climits>
 #include <string>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 namespace cli {
 class WInterface;
 
+// Returns value as a terminated string. A value that is a slice of a longer
+// comma separated list is copied into scratch, which the next item reuses.
+inline const char * terminated_value(Arg_View value, cli_string& scratch) {
+	if (value.data[value.length] == '\0') {
+		return value.data;
+	}
+	scratch.assign(value.data, value.length);
+	return scratch.c_str();
+}
+
 // Named after the -W flag of gcc
 class WSpecialization {
 friend class WInterface;
+friend class Wgroup;
 friend class Var<WSpecialization>;
 private:
-	std::unordered_map<std::string, WInterface *> setters;
+	cli_memory_resource * resource = default_memory_resource();
+	View_Table<WInterface *> setters;
+	cli_string scratch;
+private:
+	WInterface * find(Arg_View flag);
+	bool dispatch(Arg_View flag);
 public:
 	WSpecialization(size_t initial_size) {
 		setters.reserve(initial_size);
 	}
+#ifdef CPP_CLI_PMR
+	WSpecialization(size_t initial_size, cli_memory_resource * r) : resource(r), setters(r), scratch(r) {
+		setters.reserve(initial_size);
+	}
+#endif
 	WInterface * operator[](const std::string& flag) {
-		return setters[flag];
+		return find(Arg_View(flag.c_str(), flag.length()));
 	}
 };
 
+// The alias is not copied, so it must outlive the WSpecialization, just like
+// the aliases of a Var. A negatable setter also answers to "no-" + alias
+// without needing its own entry in the table.
 class WInterface {
 protected:
 	void * base_variable;
+	bool negatable_var;
+protected:
+	// Setters that keep tables or buffers of their own take them from the
+	// resource of their WSpecialization.
+	static cli_memory_resource * resource_of(WSpecialization & w_s) {
+		return w_s.resource;
+	}
 public:
-	WInterface(void * b_v, WSpecialization & w_s, std::string alias) : base_variable(b_v) {
-		w_s.setters.insert({alias, this});
+	WInterface(void * b_v, WSpecialization & w_s, const char * alias, bool n = false) : base_variable(b_v), negatable_var(n) {
+		w_s.setters.insert(Arg_View(alias), this);
+	}
+	virtual ~WInterface() = default;
+	bool negatable() const {
+		return negatable_var;
 	}
 	virtual void set_base_variable(const char * flag) = 0;
+	// Called by the WSpecialization with the value as a view into the command
+	// line, which is only terminated if it ends the argument. The default
+	// hands set_base_variable a terminated copy that only lasts until the next
+	// item of the list, so setters that keep the pointer override this.
+	virtual void set_base_view(Arg_View value, cli_string& scratch) {
+		set_base_variable(terminated_value(value, scratch));
+	}
+	virtual void set_negated_variable(const char * flag) {
+		(void)flag;
+		raise_error<std::invalid_argument>("This option cannot be negated with no-.");
+	}
 };
 
+inline WInterface * WSpecialization::find(Arg_View flag) {
+	WInterface * const * setter = setters.find(flag);
+	return setter == nullptr ? nullptr : *setter;
+}
+
+// Finds the setter for "name", "name=value" or "name,value" and hands it the
+// value. The flag may be a slice of a longer comma separated list, so the
+// value is passed as a view, and only copied for setters that need a
+// terminated string.
+inline bool WSpecialization::dispatch(Arg_View flag) {
+	size_t split = 0;
+	while (split < flag.length && flag.data[split] != '=' && flag.data[split] != ',') {
+		split++;
+	}
+	Arg_View name(flag.data, split);
+	const char * arg = flag.data + split + (split < flag.length);
+	Arg_View value(arg, flag.data + flag.length - arg);
+
+	WInterface * setter = find(name);
+	if (setter != nullptr) {
+		setter->set_base_view(value, scratch);
+		return true;
+	}
+	if (name.starts_with("no-", 3)) {
+		setter = find(name.substr(3));
+		if (setter != nullptr && setter->negatable()) {
+			setter->set_negated_variable(terminated_value(value, scratch));
+			return true;
+		}
+	}
+	return false;
+}
+
+// Calls f(piece) for every comma separated piece of list in a single pass.
+template <typename F>
+inline void for_each_list_item(const char * list, F f) {
+	const char * start = list;
+	const char * cur = list;
+	for (;; cur++) {
+		if (*cur == ',' || *cur == '\0') {
+			f(Arg_View(start, cur - start));
+			if (*cur == '\0') {
+				break;
+			}
+			start = cur + 1;
+		}
+	}
+}
+
 template <typename T>
 class Wvalue : public WInterface {
 private:
@@ -45,12 +143,41 @@ public:
 			error_message.reserve(64);
 			error_message += flag;
 			error_message += " does not require arguments.";
-			throw std::invalid_argument(error_message);
+			raise_error<std::invalid_argument>(error_message);
 		}
 		*(T *)base_variable = value;
 	}
 };
 
+// A Wvalue that also accepts the "no-" prefix, so "-Wsign-conversion" sets the
+// variable to on and "-Wno-sign-conversion" sets it to off with one entry.
+template <typename T>
+class Wflag : public WInterface {
+private:
+	T on;
+	T off;
+private:
+	void check_no_arguments(const char * flag) {
+		if (flag[0] != '\0') {
+			std::string error_message;
+			error_message.reserve(64);
+			error_message += flag;
+			error_message += " does not require arguments.";
+			raise_error<std::invalid_argument>(error_message);
+		}
+	}
+public:
+	Wflag(T & b_v, WSpecialization & w_s, const char * flag, T o = T(1), T f = T(0)) : WInterface(&b_v, w_s, flag, true), on(o), off(f) {}
+	virtual void set_base_variable(const char * flag) {
+		check_no_arguments(flag);
+		*(T *)base_variable = on;
+	}
+	virtual void set_negated_variable(const char * flag) {
+		check_no_arguments(flag);
+		*(T *)base_variable = off;
+	}
+};
+
 template <typename T>
 class Warg : public WInterface {
 public:
@@ -58,8 +185,32 @@ public:
 	virtual void set_base_variable(const char * arg) {
 		*(T *)base_variable = arg;
 	}
+	virtual void set_base_view(Arg_View value, cli_string& scratch) {
+		WInterface::set_base_view(value, scratch);
+	}
 };
 
+// A view keeps pointing into the command line, wherever the value is in a
+// list.
+template<>
+inline void Warg<Arg_View>::set_base_view(Arg_View value, cli_string& scratch) {
+	(void)scratch;
+	*(Arg_View *)base_variable = value;
+}
+
+// Only a value that ends its argument is terminated in the command line, so a
+// value followed by more items of a list cannot be kept as a const char *.
+template<>
+inline void Warg<const char *>::set_base_view(Arg_View value, cli_string& scratch) {
+	(void)scratch;
+	if (value.data[value.length] != '\0') {
+		const char * error_message = "A value followed by more items of a list is not null terminated, so "
+		"it cannot be stored as const char *. Use Arg_View, std::string, or another template overload.";
+		raise_error<std::invalid_argument>(error_message);
+	}
+	*(const char **)base_variable = value.data;
+}
+
 template<>
 class Warg<char> : public WInterface {
 private:
@@ -77,25 +228,223 @@ public:
 	}
 };
 
+// The WSpecialization version of a Choice, as in -Wtype=file.
+template <typename T>
+class Wchoice : public WInterface {
+private:
+	View_Table<T> choices;
+	const char * alias;
+public:
+	Wchoice(T & b_v, WSpecialization & w_s, const char * a, std::vector<std::pair<const char *, T>> c) : WInterface(&b_v, w_s, a), choices(make_container<View_Table<T>>(resource_of(w_s))), alias(a) {
+		choices.reserve(c.size());
+		for (size_t i = 0; i < c.size(); i++) {
+			choices.insert(Arg_View(c[i].first), c[i].second);
+		}
+	}
+	virtual void set_base_variable(const char * arg) {
+		const T * choice = choices.find(Arg_View(arg));
+		if (choice == nullptr) {
+			std::string error_message;
+			error_message.reserve(128);
+			error_message += "Invalid value for ";
+			error_message += alias;
+			error_message += ": ";
+			error_message += arg;
+			raise_error<std::invalid_argument>(error_message);
+		}
+		*(T *)base_variable = *choice;
+	}
+};
+
+// Appends every item of a comma separated list, as in
+// "-fsanitize=address,undefined", to a vector. Items are converted the same
+// way a Vector converts its arguments.
+template <typename T>
+class Wlist : public WInterface {
+private:
+	cli_string scratch;
+public:
+	Wlist(std::vector<T> & b_v, WSpecialization & w_s, const char * alias) : WInterface(&b_v, w_s, alias), scratch(make_container<cli_string>(resource_of(w_s))) {}
+	virtual void set_base_variable(const char * arg) {
+		std::vector<T>& base_variable_vector = *(std::vector<T> *)base_variable;
+		for_each_list_item(arg, [&](Arg_View item) {
+			const char * item_str = item.data;
+			if (item.data[item.length] != '\0') {
+				scratch.assign(item.data, item.length);
+				item_str = scratch.c_str();
+			}
+			T temp;
+			Var<T> temp_var(temp, {}, true);
+			temp_var.set_base_variable(item_str);
+			base_variable_vector.push_back(temp);
+		});
+	}
+	virtual void set_base_view(Arg_View value, cli_string& scratch) {
+		WInterface::set_base_view(value, scratch);
+	}
+};
+
+// Views point straight into the command line, so this is a pass-through that
+// never copies, such as collecting "-Wl,--gc-sections,-O1" for the linker.
+template<>
+inline void Wlist<Arg_View>::set_base_variable(const char * arg) {
+	std::vector<Arg_View>& base_variable_vector = *(std::vector<Arg_View> *)base_variable;
+	for_each_list_item(arg, [&](Arg_View item) {
+		base_variable_vector.push_back(item);
+	});
+}
+
+// The value may be a slice of a longer list, so it is split where it is
+// rather than copied first.
+template<>
+inline void Wlist<Arg_View>::set_base_view(Arg_View value, cli_string& scratch) {
+	(void)scratch;
+	std::vector<Arg_View>& base_variable_vector = *(std::vector<Arg_View> *)base_variable;
+	const char * start = value.data;
+	const char * end = value.data + value.length;
+	for (const char * cur = start;; cur++) {
+		if (cur == end || *cur == ',') {
+			base_variable_vector.push_back(Arg_View(start, cur - start));
+			if (cur == end) {
+				break;
+			}
+			start = cur + 1;
+		}
+	}
+}
+
+template<>
+inline void Wlist<const char *>::set_base_variable(const char * arg) {
+	(void)arg;
+	const char * error_message = "The items of a list are not null terminated, so they cannot be "
+	"stored as const char *. Use Arg_View, std::string, or another template overload.";
+	raise_error<std::invalid_argument>(error_message);
+}
+
+// Sets one bit of an integer per named item of a comma separated list. The
+// ith name corresponds to bit i, so T has to be unsigned and there can be no
+// more names than it has bits. "no-" + alias clears the listed bits instead.
+template <typename T>
+class Wbitmask : public WInterface {
+	static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value, "Wbitmask needs an unsigned integer type.");
+private:
+	View_Table<T> bits;
+	const char * alias;
+private:
+	T mask_of(const char * arg) {
+		T mask = 0;
+		for_each_list_item(arg, [&](Arg_View item) {
+			const T * bit = bits.find(item);
+			if (bit == nullptr) {
+				std::string error_message;
+				error_message.reserve(128);
+				error_message += "Unrecognized value for ";
+				error_message += alias;
+				error_message += ": ";
+				error_message += item.str();
+				raise_error<std::invalid_argument>(error_message);
+			}
+			mask |= *bit;
+		});
+		return mask;
+	}
+	// Called before the setter is added to the table, so that it is not left
+	// there if the names do not fit.
+	static const char * checked_alias(const char * a, size_t num_names) {
+		if (num_names > sizeof(T) * CHAR_BIT) {
+			std::string error_message;
+			error_message.reserve(128);
+			error_message += "Too many names for the bits of ";
+			error_message += a;
+			error_message += ": ";
+			error_message += std::to_string(num_names);
+			error_message += " names, but only ";
+			error_message += std::to_string(sizeof(T) * CHAR_BIT);
+			error_message += " bits.";
+			raise_error<std::invalid_argument>(error_message);
+		}
+		return a;
+	}
+public:
+	Wbitmask(T & b_v, WSpecialization & w_s, const char * a, std::vector<const char *> names) : WInterface(&b_v, w_s, checked_alias(a, names.size()), true), bits(make_container<View_Table<T>>(resource_of(w_s))), alias(a) {
+		bits.reserve(names.size());
+		for (size_t i = 0; i < names.size(); i++) {
+			bits.insert(Arg_View(names[i]), (T)((T)1 << i));
+		}
+	}
+	virtual void set_base_variable(const char * arg) {
+		*(T *)base_variable |= mask_of(arg);
+	}
+	virtual void set_negated_variable(const char * arg) {
+		*(T *)base_variable &= (T)~mask_of(arg);
+	}
+};
+
+// A nested namespace. Every item of the comma separated list is looked up in
+// another WSpecialization, so "-Wl,gc-sections,opt=1" behaves like "-Wl"
+// passing "gc-sections" and "opt=1" to its own set of suboptions. Items the
+// nested WSpecialization does not know are an error, unless unrecognized is
+// given, in which case they are appended to it as views into the command line.
+class Wgroup : public WInterface {
+private:
+	const char * alias;
+	std::vector<Arg_View> * unrecognized;
+public:
+	Wgroup(WSpecialization & b_v, WSpecialization & w_s, const char * a, std::vector<Arg_View> * u = nullptr) : WInterface(&b_v, w_s, a), alias(a), unrecognized(u) {}
+	virtual void set_base_variable(const char * arg) {
+		WSpecialization * nested = (WSpecialization *)base_variable;
+		for_each_list_item(arg, [&](Arg_View item) {
+			if (nested->dispatch(item)) {
+				return;
+			}
+			if (unrecognized != nullptr) {
+				unrecognized->push_back(item);
+			} else {
+				std::string error_message;
+				error_message.reserve(128);
+				error_message += "Option does not exist in ";
+				error_message += alias;
+				error_message += ": ";
+				error_message += item.str();
+				raise_error<std::invalid_argument>(error_message);
+			}
+		});
+	}
+};
+
+// An unknown suboption is reported without throwing, so that Parser::try_parse
+// can return it. Errors raised by the setters themselves are still thrown.
 template<>
+class Var<WSpecialization> : public CLI_Interface {
+public:
+	Var(WSpecialization & b_v, std::vector<const char *> a, bool ta, const char * hm = "") : CLI_Interface(&b_v, std::move(a), ta, hm) {}
+	Var(WSpecialization * b_v, std::vector<const char *> a, bool ta, const char * hm = "") : CLI_Interface(b_v, std::move(a), ta, hm) {}
+	virtual void set_base_variable(const char * flag);
+	virtual bool try_set_base_variable(const char * flag);
+	virtual std::string invalid_value_message(Arg_View flag) const;
+};
+
 inline void Var<WSpecialization>::set_base_variable(const char * flag) {
-	std::string flag_str = flag;
-	size_t split_location = flag_str.find('=');
-	std::string temp_flag = flag_str.substr(0, split_location);
-	if (split_location == std::string::npos) {
-		split_location = flag_str.length();
-	} else {
-		split_location++;
-	}
-	if (((WSpecialization *)base_variable)->setters.count(temp_flag) == 0) {
-		std::string error_message;
-		error_message.reserve(200);
-		error_message = "Option does not exist: -";
-		error_message += aliases[0];
-		error_message += temp_flag;
-		throw std::invalid_argument(error_message);
-	}
-	((WSpecialization *)base_variable)->setters[temp_flag]->set_base_variable(flag + split_location);
+	if (!try_set_base_variable(flag)) {
+		raise_error<std::invalid_argument>(invalid_value_message(Arg_View(flag)));
+	}
+}
+
+inline bool Var<WSpecialization>::try_set_base_variable(const char * flag) {
+	return ((WSpecialization *)base_variable)->dispatch(Arg_View(flag));
+}
+
+inline std::string Var<WSpecialization>::invalid_value_message(Arg_View flag) const {
+	size_t split = 0;
+	while (split < flag.length && flag.data[split] != '=' && flag.data[split] != ',') {
+		split++;
+	}
+	std::string error_message;
+	error_message.reserve(200);
+	error_message = "Option does not exist: -";
+	error_message += aliases[0];
+	error_message.append(flag.data, split);
+	return error_message;
 }
 
 template<>
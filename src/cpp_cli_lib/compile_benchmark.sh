@@ -0,0 +1,99 @@
+#!/bin/sh
+# Times the build of a generated project of many translation units, each of
+# which sets up and runs a parser with a handful of options, three ways:
+#
+#	header only	#include "cpp_cli.h"
+#	compiled	#include "cpp_cli.h" with -DCPP_CLI_COMPILED, linking libcpp_cli.a
+#	header unit	import "cpp_cli.h"; linking libcpp_cli.a
+#
+# Build the library and the header unit first, with make and make module in
+# bin, then run it from this directory:
+#
+#	./compile_benchmark.sh [translation units] [parallel jobs]
+#
+# CXX and CXXFLAGS pick the compiler and the flags, g++ and -O2 by default.
+set -e
+
+UNITS=${1:-500}
+JOBS=${2:-$(nproc)}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2}
+HERE=$(cd "$(dirname "$0")" && pwd)
+INCLUDE=$(cd "$HERE/external_includes" && pwd -P)
+LIBRARY=$HERE/bin/libcpp_cli.a
+MAPPER=$HERE/bin/cpp_cli.mapper
+
+if [ ! -f "$LIBRARY" ] || [ ! -f "$MAPPER" ]; then
+	echo "Build the library first: make && make module in $HERE/bin" >&2
+	exit 1
+fi
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# $1 is the line that brings in the library.
+generate() {
+	mkdir -p "$WORK/$2"
+	i=0
+	while [ $i -lt "$UNITS" ]; do
+		cat > "$WORK/$2/unit_$i.cpp" <<EOF
+$1
+
+int unit_$i(int argc, char ** argv) {
+	cli::Parser p;
+	int count = 0;
+	double ratio = 1.0;
+	bool verbose = false;
+	std::string name;
+	std::vector<std::string> files;
+	p.arg(count, { "c", "count" }, "How many.");
+	p.arg(ratio, { "r", "ratio" }, "How much.");
+	p.value(verbose, { "v", "verbose" }, true, "Prints more.");
+	p.arg(name, { "n", "name" }, "Who.");
+	p.vector(files, { "f", "file" }, "Which files.");
+	p.parse(argc, argv);
+	return count + (int)ratio + verbose + (int)name.size() + (int)files.size() + $i;
+}
+EOF
+		i=$((i + 1))
+	done
+	cat > "$WORK/$2/main.cpp" <<EOF
+int unit_0(int argc, char ** argv);
+
+int main(int argc, char ** argv) {
+	return unit_0(argc, argv);
+}
+EOF
+}
+
+# Compiles every unit of $1 with the flags that follow, JOBS at a time, and
+# prints the wall time.
+build() {
+	directory=$1
+	shift
+	start=$(date +%s.%N)
+	ls "$WORK/$directory"/*.cpp | xargs -P "$JOBS" -I {} $CXX $CXXFLAGS "$@" -c {} -o {}.o
+	end=$(date +%s.%N)
+	echo "$start $end" | awk -v units="$UNITS" -v name="$directory" '{ printf "%-12s %8.1f s\t%6.0f ms per translation unit\n", name ":", $2 - $1, ($2 - $1) * 1000 / (units + 1) }'
+}
+
+generate '#include "cpp_cli.h"' header_only
+generate '#include "cpp_cli.h"' compiled
+generate 'import "cpp_cli.h";' header_unit
+
+echo "$UNITS translation units, $JOBS jobs, $CXX $CXXFLAGS"
+build header_only -std=c++11 -I"$INCLUDE"
+$CXX $CXXFLAGS "$WORK"/header_only/*.o -o "$WORK/header_only/program"
+build compiled -std=c++11 -DCPP_CLI_COMPILED -I"$INCLUDE"
+$CXX $CXXFLAGS "$WORK"/compiled/*.o "$LIBRARY" -o "$WORK/compiled/program"
+build header_unit -std=c++20 -fmodules-ts -DCPP_CLI_COMPILED -I"$INCLUDE" -fmodule-mapper="$MAPPER"
+$CXX $CXXFLAGS "$WORK"/header_unit/*.o "$LIBRARY" -o "$WORK/header_unit/program"
+# Each program returns 2 + 1 + 3 + 2 for this command line.
+for directory in header_only compiled header_unit; do
+	status=0
+	"$WORK/$directory/program" -c 2 -n abc -f x -f y > /dev/null || status=$?
+	if [ $status -ne 8 ]; then
+		echo "$directory: the program returned $status instead of 8" >&2
+		exit 1
+	fi
+done
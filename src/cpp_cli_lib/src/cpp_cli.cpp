@@ -0,0 +1,6 @@
+// Everything the headers leave out for programs built with CPP_CLI_COMPILED,
+// compiled once: the parser, its help and its options, along with the options
+// for the built in types. The library has to be built with the same macros as
+// the programs using it, such as CPP_CLI_PMR or CPP_CLI_LEAN.
+#define CPP_CLI_LIBRARY
+#include "cpp_cli.h"
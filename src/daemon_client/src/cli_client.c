@@ -0,0 +1,185 @@
+#define _XOPEN_SOURCE 700
+#include "cli_daemon_protocol.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/* Sends its command line, environment and working directory to a program
+ * running cli::serve, hands it its standard input, output and error, and
+ * exits with the status the command line had there:
+ *
+ *	cli-client [socket path] [program name] [arguments...]
+ *
+ * The program name becomes argv[0] on the server. */
+
+extern char ** environ;
+
+static int fail(const char * what) {
+	fprintf(stderr, "cli-client: %s: %s\n", what, strerror(errno));
+	return 1;
+}
+
+static size_t append(char * payload, size_t size, const char * str) {
+	size_t length = strlen(str) + 1;
+	if (payload != NULL) {
+		memcpy(payload + size, str, length);
+	}
+	return size + length;
+}
+
+/* Measures the payload if it is null, and fills it otherwise. */
+static size_t build_payload(char * payload, int argc, char ** argv, const char * directory, uint32_t * envc) {
+	size_t size = 0;
+	int i;
+	for (i = 0; i < argc; i++) {
+		size = append(payload, size, argv[i]);
+	}
+	*envc = 0;
+	for (i = 0; environ[i] != NULL; i++) {
+		size = append(payload, size, environ[i]);
+		(*envc)++;
+	}
+	return append(payload, size, directory);
+}
+
+static int write_all(int fd, const char * data, size_t size) {
+	while (size > 0) {
+		ssize_t written = write(fd, data, size);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+		if (written <= 0) {
+			return 0;
+		}
+		data += written;
+		size -= (size_t)written;
+	}
+	return 1;
+}
+
+static int read_all(int fd, char * data, size_t size) {
+	while (size > 0) {
+		ssize_t received = read(fd, data, size);
+		if (received < 0 && errno == EINTR) {
+			continue;
+		}
+		if (received <= 0) {
+			return 0;
+		}
+		data += received;
+		size -= (size_t)received;
+	}
+	return 1;
+}
+
+int main(int argc, char ** argv) {
+	struct sockaddr_un address;
+	struct cli_daemon_request header;
+	struct cli_daemon_reply reply;
+	struct iovec iov[2];
+	struct msghdr message;
+	union {
+		struct cmsghdr align;
+		char buffer[CMSG_SPACE(sizeof(int) * CLI_DAEMON_NUM_FDS)];
+	} control;
+	struct cmsghdr * cmsg;
+	char directory[PATH_MAX];
+	int fds[CLI_DAEMON_NUM_FDS];
+	char * payload;
+	size_t payload_size;
+	ssize_t sent;
+	int connection;
+	int i;
+
+	if (argc < 3) {
+		fprintf(stderr, "usage: cli-client [socket path] [program name] [arguments...]\n");
+		return 2;
+	}
+	if (strlen(argv[1]) >= sizeof(address.sun_path)) {
+		fprintf(stderr, "cli-client: the socket path is too long: %s\n", argv[1]);
+		return 1;
+	}
+	if (getcwd(directory, sizeof(directory)) == NULL) {
+		return fail("could not get the working directory");
+	}
+
+	header.magic = CLI_DAEMON_MAGIC;
+	header.version = CLI_DAEMON_VERSION;
+	header.argc = (uint32_t)(argc - 2);
+	payload_size = build_payload(NULL, argc - 2, argv + 2, directory, &header.envc);
+	if (payload_size > CLI_DAEMON_MAX_PAYLOAD) {
+		fprintf(stderr, "cli-client: the command line and environment are too large to send\n");
+		return 1;
+	}
+	header.payload_size = (uint32_t)payload_size;
+	payload = malloc(payload_size);
+	if (payload == NULL) {
+		return fail("could not allocate the request");
+	}
+	build_payload(payload, argc - 2, argv + 2, directory, &header.envc);
+
+	/* A closed descriptor cannot be sent, so /dev/null stands in for it. */
+	for (i = 0; i < CLI_DAEMON_NUM_FDS; i++) {
+		fds[i] = i;
+		if (fcntl(i, F_GETFD) < 0) {
+			fds[i] = open("/dev/null", i == 0 ? O_RDONLY : O_WRONLY);
+		}
+	}
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, argv[1]);
+	/* A server that goes away is reported, rather than killing the client. */
+	signal(SIGPIPE, SIG_IGN);
+	connection = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (connection < 0) {
+		return fail("could not create a socket");
+	}
+	if (connect(connection, (const struct sockaddr *)&address, sizeof(address)) != 0) {
+		return fail(argv[1]);
+	}
+
+	/* The header and the descriptors go in one message, and whatever of the
+	 * payload did not fit is written after it. */
+	iov[0].iov_base = &header;
+	iov[0].iov_len = sizeof(header);
+	iov[1].iov_base = payload;
+	iov[1].iov_len = payload_size;
+	memset(&message, 0, sizeof(message));
+	memset(&control, 0, sizeof(control));
+	message.msg_iov = iov;
+	message.msg_iovlen = 2;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+	cmsg = CMSG_FIRSTHDR(&message);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+	do {
+		sent = sendmsg(connection, &message, 0);
+	} while (sent < 0 && errno == EINTR);
+	if (sent < (ssize_t)sizeof(header)) {
+		return fail("could not send the request");
+	}
+	if (!write_all(connection, payload + (sent - sizeof(header)), payload_size - (size_t)(sent - sizeof(header)))) {
+		return fail("could not send the request");
+	}
+	free(payload);
+
+	if (!read_all(connection, (char *)&reply, sizeof(reply))) {
+		fprintf(stderr, "cli-client: the server closed the connection without an exit status\n");
+		return 1;
+	}
+	close(connection);
+	return reply.status;
+}
@@ -0,0 +1,110 @@
+#include "cpp_cli.h"
+#include "cli_daemon.h"
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+// A small tool that runs either on its own or as a server for cli-client,
+// which saves starting a process for every command line:
+//
+//	./cli-daemon -v fetch -n 3 x
+//	./cli-daemon --serve .cli-daemon.sock &
+//	../../daemon_client/bin/cli-client .cli-daemon.sock cli-daemon -v fetch -n 3 x
+//
+// The parser and its commands are set up once, before serving starts, and
+// every command line is handled in a process forked from the server, so the
+// options always start out with the values they had then.
+
+struct Tool {
+	cli::Parser p;
+	size_t verbosity = 0;
+};
+
+struct Fetch_Options {
+	int count = 1;
+};
+
+struct Index_Options {
+	int depth = 0;
+};
+
+void print_help(cli::Parser& p, void * data) {
+	(void)data;
+	p.print_help();
+}
+
+void build_fetch(cli::Parser& p, void * data) {
+	(void)data;
+	Fetch_Options& o = p.command_state<Fetch_Options>();
+	p.arg(o.count, { "n", "count" }, "How many times to fetch each URL.");
+}
+
+void run_fetch(cli::Parser& p, void * data) {
+	Tool * tool = static_cast<Tool *>(data);
+	Fetch_Options& o = p.command_state<Fetch_Options>();
+	const cli::cli_vector<const char *>& urls = p.get_non_options();
+	for (size_t i = 0; i < urls.size(); i++) {
+		std::cout << "fetch " << urls[i] << " x" << o.count;
+		if (tool->verbosity > 0) {
+			std::cout << " (verbosity " << tool->verbosity << ")";
+		}
+		std::cout << std::endl;
+	}
+}
+
+void build_index(cli::Parser& p, void * data) {
+	(void)data;
+	Index_Options& o = p.command_state<Index_Options>();
+	p.arg(o.depth, { "d", "depth" }, "How deep to index.");
+}
+
+void run_index(cli::Parser& p, void * data) {
+	(void)data;
+	Index_Options& o = p.command_state<Index_Options>();
+	const cli::cli_vector<const char *>& paths = p.get_non_options();
+	for (size_t i = 0; i < paths.size(); i++) {
+		std::cout << "index " << paths[i] << " to depth " << o.depth << std::endl;
+	}
+}
+
+// What main would do with the command line, called once per command line
+// when serving.
+int handle(int argc, char ** argv, void * data) {
+	Tool * tool = static_cast<Tool *>(data);
+	cli::Parse_Error error = tool->p.try_parse(argc, argv, tool);
+	if (error) {
+		std::cerr << error.message() << std::endl;
+		return 2;
+	}
+	return 0;
+}
+
+int main(int argc, char ** argv) {
+	Tool tool;
+	tool.p.count(tool.verbosity, { "v", "verbose" }, "Prints more. Can be repeated.");
+	tool.p.action(print_help, nullptr, { "h", "help" }, "Prints this help message and exits.");
+	tool.p.add_command("fetch", build_fetch, run_fetch, "Fetches every URL given to it.");
+	tool.p.add_command("index", build_index, run_index, "Indexes every path given to it.");
+
+	tool.p.set_usage("[-v] [command] [command's options/non-options]\n\t--serve [socket path]");
+	tool.p.set_header("Demonstrates serving command lines from a long running process with cli::serve. "
+	"Run it with '--serve [socket path]' and send it command lines with cli-client.");
+	// Command lines run in the working directory of the client, so the help
+	// file has to be found by an absolute path.
+	char directory[4096];
+	if (getcwd(directory, sizeof(directory)) == nullptr) {
+		return 1;
+	}
+	tool.p.set_help_file_path(std::string(directory) + "/");
+	tool.p.generate_help(argv[0]);
+
+	if (argc == 3 && strcmp(argv[1], "--serve") == 0) {
+		// generate_help only checks the help file once a command line has
+		// been parsed. Parsing an empty one here checks it once, rather than
+		// in the process of every command line served.
+		tool.p.try_parse(1, argv, &tool);
+		cli::serve(argv[2], handle, &tool);
+	}
+	return handle(argc, argv, &tool);
+}
@@ -0,0 +1,367 @@
+#include "cpp_cli.h"
+#include "static_parser.h"
+#include "parallel_parse.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Compares the runtime Parser against a Static_Parser with the same options
+// over a representative command line. "setup + parse" constructs and fills a
+// parser every iteration, like a short lived program does once per run.
+// "parse" reuses one parser, like a program that parses many command lines.
+// "make_argv" builds the argv of a child process from the parsed values.
+// The last measurements convert a long list of values with parse and with
+// parse_parallel, and restore the same values from a snapshot image. Before
+// parsing, every argument is classified in one pass, with SSE2 where it is
+// available, and both ways of classifying are also measured on their own.
+// "make scalar" builds cli-bench-scalar with CPP_CLI_NO_SIMD, whose parse of
+// the long list is classified by the scalar loop.
+// Finally, a long list of heavily repeated paths is collected as
+// std::strings and as Interned strings, and 32 boolean flags are set up and
+// parsed as a bool each and as one word of packed flags. Built with
+// CPP_CLI_PMR, which needs C++17, it also parses with a Parser whose memory
+// comes from a buffer on the stack.
+//
+// Every allocation through the global operator new is counted, to show what
+// setting up and parsing costs besides time.
+
+static std::atomic<size_t> global_allocations(0);
+
+void * operator new(size_t size) {
+	global_allocations.fetch_add(1, std::memory_order_relaxed);
+	void * memory = malloc(size == 0 ? 1 : size);
+	if (memory == nullptr) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+#ifdef __cpp_aligned_new
+// std::pmr::new_delete_resource allocates through the aligned version.
+void * operator new(size_t size, std::align_val_t alignment) {
+	global_allocations.fetch_add(1, std::memory_order_relaxed);
+	void * memory = aligned_alloc((size_t)alignment, (size + (size_t)alignment - 1) / (size_t)alignment * (size_t)alignment);
+	if (memory == nullptr) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete(void * memory, std::align_val_t alignment) noexcept {
+	(void)alignment;
+	free(memory);
+}
+
+void operator delete(void * memory, size_t size, std::align_val_t alignment) noexcept {
+	(void)size;
+	(void)alignment;
+	free(memory);
+}
+#endif
+
+// Not inlined, so that the compiler does not mistake the free for a mismatched
+// deallocation of memory from operator new.
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+void operator delete(void * memory) noexcept {
+	free(memory);
+}
+
+void operator delete(void * memory, size_t size) noexcept {
+	(void)size;
+	operator delete(memory);
+}
+
+struct Options {
+	std::string filename;
+	int recursion_level = -1;
+	double probability = 0.0;
+	size_t verbosity = 0;
+	char flag = '\0';
+	bool help = false;
+	std::vector<int> list_of_ints;
+	std::vector<const char *> declarations;
+
+	void reset() {
+		verbosity = 0;
+		list_of_ints.clear();
+		declarations.clear();
+	}
+};
+
+constexpr cli::Static_Alias benchmark_aliases[] = {
+	cli::static_alias("f", 0), cli::static_alias("file", 0), cli::static_alias("filename", 0),
+	cli::static_alias("r", 1), cli::static_alias("recursion", 1), cli::static_alias("max-depth", 1),
+	cli::static_alias("p", 2), cli::static_alias("prob", 2), cli::static_alias("probability", 2),
+	cli::static_alias("v", 3),
+	cli::static_alias("a", 4), cli::static_alias("flag", 4),
+	cli::static_alias("b", 5), cli::static_alias("no-flag", 5),
+	cli::static_alias("h", 6), cli::static_alias("help", 6),
+	cli::static_alias("i", 7), cli::static_alias("list", 7),
+	cli::static_alias("D", 8),
+};
+
+static const char * benchmark_args[] = {
+	"cli-bench", "-f", "input.txt", "--recursion=3", "--prob=0.25", "-vvv", "--flag", "-b",
+	"-i", "1", "-i2", "--list=3", "-DNDEBUG", "-D", "VERSION=2", "first", "second", "--", "-third"
+};
+static const int benchmark_argc = sizeof(benchmark_args) / sizeof(benchmark_args[0]);
+
+static void fill_runtime_parser(cli::Parser& p, Options& o) {
+	p.arg(o.filename, { "f", "file", "filename" });
+	p.arg(o.recursion_level, { "r", "recursion", "max-depth" });
+	p.arg(o.probability, { "p", "prob", "probability" });
+	p.repeated(o.verbosity, { "v" });
+	p.value(o.flag, { "a", "flag" }, 'a');
+	p.value(o.flag, { "b", "no-flag" }, 'b');
+	p.value(o.help, { "h", "help" }, true);
+	p.vector(o.list_of_ints, { "i", "list" });
+	p.vector(o.declarations, { "D" });
+}
+
+template <typename F>
+static size_t allocations_per_iteration(F f) {
+	size_t before = global_allocations.load();
+	f();
+	return global_allocations.load() - before;
+}
+
+template <typename F>
+static double time_per_iteration(size_t iterations, F f) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < iterations; i++) {
+		f();
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+int main(int argc, char ** argv) {
+	size_t iterations = 200000;
+	size_t num_values = 100000;
+	size_t num_threads = std::thread::hardware_concurrency();
+	{
+		cli::Parser p;
+		p.arg(iterations, { "n", "iterations" }, "Number of iterations per measurement.");
+		p.arg(num_values, { "values" }, "Number of values in the long list.");
+		p.arg(num_threads, { "j", "threads" }, "Number of threads used by parse_parallel.");
+		p.parse(argc, argv);
+	}
+
+	// The runtime Parser never writes to argv, so it parses benchmark_args as
+	// it is. The Static_Parser moves the non-options to the front of argv, so
+	// it gets a fresh copy of the pointers every iteration.
+	std::vector<std::string> storage(benchmark_args, benchmark_args + benchmark_argc);
+	std::vector<char *> args(benchmark_argc);
+	size_t num_non_options = 0;
+	Options o;
+
+	auto runtime_iteration = [&]() {
+		o.reset();
+		cli::Parser p;
+		fill_runtime_parser(p, o);
+		num_non_options += p.parse(benchmark_argc, benchmark_args).size();
+	};
+	size_t runtime_allocations = allocations_per_iteration(runtime_iteration);
+	double runtime_setup_and_parse = time_per_iteration(iterations, runtime_iteration);
+
+#ifdef CPP_CLI_PMR
+	// The options' alias lists and the values bound to them still use the
+	// global allocator, everything inside the Parser comes from the buffer.
+	auto pmr_iteration = [&]() {
+		o.reset();
+		alignas(std::max_align_t) char buffer[16384];
+		std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+		cli::Parser p(&arena);
+		fill_runtime_parser(p, o);
+		num_non_options += p.parse(benchmark_argc, benchmark_args).size();
+	};
+	size_t pmr_allocations = allocations_per_iteration(pmr_iteration);
+	double pmr_setup_and_parse = time_per_iteration(iterations, pmr_iteration);
+#endif
+
+	cli::Parser reused;
+	fill_runtime_parser(reused, o);
+	double runtime_parse = time_per_iteration(iterations, [&]() {
+		o.reset();
+		num_non_options += reused.parse(benchmark_argc, benchmark_args).size();
+	});
+
+	size_t argv_length = 0;
+	auto make_argv_iteration = [&]() {
+		cli::Argv_Buffer child_argv = reused.make_argv("child");
+		argv_length += child_argv.argc();
+	};
+	size_t make_argv_allocations = allocations_per_iteration(make_argv_iteration);
+	double make_argv = time_per_iteration(iterations, make_argv_iteration);
+
+	double static_setup_and_parse = time_per_iteration(iterations, [&]() {
+		for (int i = 0; i < benchmark_argc; i++) {
+			args[i] = &storage[i][0];
+		}
+		o.reset();
+		auto p = cli::make_static_parser<cli::static_size(benchmark_aliases), benchmark_aliases>(
+			cli::static_arg(o.filename),
+			cli::static_arg(o.recursion_level),
+			cli::static_arg(o.probability),
+			cli::static_count(o.verbosity),
+			cli::static_value(o.flag, 'a'),
+			cli::static_value(o.flag, 'b'),
+			cli::static_value(o.help, true),
+			cli::static_vector(o.list_of_ints),
+			cli::static_vector(o.declarations)
+		);
+		num_non_options += p.parse(benchmark_argc, args.data());
+	});
+
+	std::vector<std::string> list_storage(1, "cli-bench");
+	for (size_t i = 0; i < num_values; i++) {
+		list_storage.push_back("--value=" + std::to_string(i * 0.25));
+	}
+	std::vector<char *> list_args(list_storage.size());
+	for (size_t i = 0; i < list_storage.size(); i++) {
+		list_args[i] = &list_storage[i][0];
+	}
+	std::vector<double> values;
+	cli::Parser list_parser;
+	list_parser.vector(values, { "value" });
+	size_t list_iterations = iterations / num_values + 1;
+
+	double list_parse = time_per_iteration(list_iterations, [&]() {
+		values.clear();
+		list_parser.parse(list_args.size(), list_args.data());
+	});
+	double list_parse_parallel = time_per_iteration(list_iterations, [&]() {
+		values.clear();
+		cli::parse_parallel(list_parser, list_args.size(), list_args.data(), num_threads);
+	});
+
+	std::vector<cli::Arg_Token> list_tokens(list_args.size());
+	size_t token_lengths = 0;
+	double list_classify = time_per_iteration(list_iterations, [&]() {
+		cli::classify_arguments(list_args.size(), list_args.data(), list_tokens.data());
+		token_lengths += list_tokens.back().split;
+	});
+	double list_classify_scalar = time_per_iteration(list_iterations, [&]() {
+		for (size_t i = 0; i < list_args.size(); i++) {
+			list_tokens[i] = cli::classify_argument_scalar(list_args[i]);
+		}
+		token_lengths += list_tokens.back().split;
+	});
+
+	std::vector<char> image(list_parser.save_snapshot(nullptr));
+	list_parser.save_snapshot(image.data());
+	double list_load_snapshot = time_per_iteration(list_iterations, [&]() {
+		values.clear();
+		list_parser.load_snapshot(image.data(), image.size());
+	});
+
+	std::vector<std::string> path_storage(1, "cli-bench");
+	for (size_t i = 0; i < num_values; i++) {
+		path_storage.push_back("--include=/usr/local/include/project-" + std::to_string(i % 32));
+	}
+	std::vector<const char *> path_args(path_storage.size());
+	for (size_t i = 0; i < path_storage.size(); i++) {
+		path_args[i] = path_storage[i].c_str();
+	}
+	std::vector<std::string> string_paths;
+	cli::Parser string_parser;
+	string_parser.vector(string_paths, { "include" });
+	auto string_paths_iteration = [&]() {
+		std::vector<std::string>().swap(string_paths);
+		string_parser.parse(path_args.size(), path_args.data());
+	};
+	size_t string_paths_allocations = allocations_per_iteration(string_paths_iteration);
+	double string_paths_parse = time_per_iteration(list_iterations, string_paths_iteration);
+
+	std::vector<cli::Interned> interned_paths;
+	cli::Parser interned_parser;
+	interned_parser.vector(interned_paths, { "include" });
+	auto interned_paths_iteration = [&]() {
+		std::vector<cli::Interned>().swap(interned_paths);
+		interned_parser.parse(path_args.size(), path_args.data());
+	};
+	size_t interned_paths_allocations = allocations_per_iteration(interned_paths_iteration);
+	double interned_paths_parse = time_per_iteration(list_iterations, interned_paths_iteration);
+	size_t distinct_paths = 0;
+	for (size_t i = 0; i < interned_paths.size(); i++) {
+		distinct_paths += interned_paths[i] == interned_parser.intern("/usr/local/include/project-0");
+	}
+
+	const size_t num_features = 32;
+	std::vector<std::string> feature_names;
+	for (size_t i = 0; i < num_features; i++) {
+		feature_names.push_back("feature-" + std::to_string(i));
+	}
+	std::vector<std::string> feature_storage(1, "cli-bench");
+	for (size_t i = 0; i < num_features; i += 2) {
+		feature_storage.push_back("--" + feature_names[i]);
+	}
+	std::vector<const char *> feature_args(feature_storage.size());
+	for (size_t i = 0; i < feature_storage.size(); i++) {
+		feature_args[i] = feature_storage[i].c_str();
+	}
+	bool feature_bools[num_features];
+	size_t features_seen = 0;
+	auto bool_features_iteration = [&]() {
+		cli::Parser p;
+		for (size_t i = 0; i < num_features; i++) {
+			feature_bools[i] = false;
+			p.value(feature_bools[i], { feature_names[i].c_str() }, true);
+		}
+		p.parse(feature_args.size(), feature_args.data());
+		features_seen += feature_bools[0];
+	};
+	size_t bool_features_allocations = allocations_per_iteration(bool_features_iteration);
+	double bool_features_parse = time_per_iteration(iterations, bool_features_iteration);
+
+	uint64_t feature_word = 0;
+	std::vector<std::pair<const char *, uint64_t>> feature_bits;
+	for (size_t i = 0; i < num_features; i++) {
+		feature_bits.push_back(std::make_pair(feature_names[i].c_str(), (uint64_t)1 << i));
+	}
+	auto bits_features_iteration = [&]() {
+		cli::Parser p;
+		feature_word = 0;
+		p.bits(feature_word, feature_bits);
+		p.parse(feature_args.size(), feature_args.data());
+		features_seen += feature_word & 1;
+	};
+	size_t bits_features_allocations = allocations_per_iteration(bits_features_iteration);
+	double bits_features_parse = time_per_iteration(iterations, bits_features_iteration);
+
+	std::cout << "iterations:\t" << iterations << std::endl;
+	std::cout << "runtime Parser, setup + parse:\t" << runtime_setup_and_parse << " ns, " << runtime_allocations << " allocations" << std::endl;
+#ifdef CPP_CLI_PMR
+	std::cout << "arena Parser, setup + parse:\t" << pmr_setup_and_parse << " ns, " << pmr_allocations << " allocations" << std::endl;
+#endif
+	std::cout << "runtime Parser, parse:\t\t" << runtime_parse << " ns" << std::endl;
+	std::cout << "runtime Parser, make_argv:\t" << make_argv << " ns, " << make_argv_allocations << " allocations" << std::endl;
+	std::cout << "Static_Parser, setup + parse:\t" << static_setup_and_parse << " ns" << std::endl;
+#ifdef CPP_CLI_SSE2_TOKENS
+	std::cout << num_values << " values, parse (SSE2):\t" << list_parse / 1000000 << " ms" << std::endl;
+#else
+	std::cout << num_values << " values, parse (scalar):\t" << list_parse / 1000000 << " ms" << std::endl;
+#endif
+	std::cout << num_values << " values, parse_parallel (" << num_threads << " threads):\t" << list_parse_parallel / 1000000 << " ms" << std::endl;
+	std::cout << num_values << " values, load_snapshot:\t" << list_load_snapshot / 1000000 << " ms" << std::endl;
+#ifdef CPP_CLI_SSE2_TOKENS
+	std::cout << num_values << " values, classify (SSE2):\t" << list_classify / 1000000 << " ms" << std::endl;
+#else
+	std::cout << num_values << " values, classify:\t" << list_classify / 1000000 << " ms" << std::endl;
+#endif
+	std::cout << num_values << " values, classify (scalar):\t" << list_classify_scalar / 1000000 << " ms" << std::endl;
+	std::cout << num_values << " repeated paths, std::string:\t" << string_paths_parse / 1000000 << " ms, " << string_paths_allocations << " allocations" << std::endl;
+	std::cout << num_values << " repeated paths, Interned:\t" << interned_paths_parse / 1000000 << " ms, " << interned_paths_allocations << " allocations" << std::endl;
+	std::cout << num_features << " flags as bools, setup + parse:\t" << bool_features_parse << " ns, " << bool_features_allocations << " allocations" << std::endl;
+	std::cout << num_features << " flags as one word, setup + parse:\t" << bits_features_parse << " ns, " << bits_features_allocations << " allocations" << std::endl;
+	std::cout << "(checksum " << num_non_options + values.size() + argv_length + token_lengths + string_paths.size() + distinct_paths + features_seen << ")" << std::endl;
+	return 0;
+}
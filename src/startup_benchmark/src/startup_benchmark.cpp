@@ -0,0 +1,371 @@
+#include "cpp_cli.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <sys/ptrace.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/user.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+// Measures what users pay for every run of a program built with the library:
+// fork, exec, dynamic loading, static initialization, generate_help writing
+// the help file, and parse. Every example program is started with
+// representative command lines the given number of times for wall time and
+// peak RSS, then once more under ptrace to count its syscalls, with the
+// opens of and writes to help files counted separately. The examples have to
+// be built first, and each runs in its own bin directory, where its help
+// files are written. cli-daemon is also started as a server, and the same
+// command line is sent to it with cli-client, which compares a direct exec
+// with a request to an already running process. Only the client's syscalls
+// are counted for it.
+
+struct Scenario {
+	const char * name;
+	// Relative to the source directory. The program runs from there.
+	const char * directory;
+	const char * program;
+	// Sent to the cli-daemon server, which has to be running.
+	bool served;
+	std::vector<const char *> args;
+};
+
+struct Syscall_Counts {
+	std::map<long, size_t> by_number;
+	size_t total = 0;
+	size_t help_file_opens = 0;
+	size_t help_file_writes = 0;
+	size_t help_file_bytes = 0;
+};
+
+struct Run_Result {
+	double nanoseconds;
+	long max_rss_kib;
+	int status;
+};
+
+static const std::vector<Scenario>& scenarios() {
+	static const std::vector<Scenario> scenarios = {
+		{ "cli-test", "test_cpp_command_line_parser/bin", "./cli-test", false, { "-vvv", "-r", "3", "--flag", "-i", "1", "-i", "2", "x", "--", "-y" } },
+		{ "cli-test -h", "test_cpp_command_line_parser/bin", "./cli-test", false, { "-h" } },
+		{ "cli-test --version", "test_cpp_command_line_parser/bin", "./cli-test", false, { "--version" } },
+		{ "subcom push", "subcommand_example/bin", "./subcom", false, { "-v", "push", "-u", "x", "test", "-u", "3" } },
+		{ "subcom pull", "subcommand_example/bin", "./subcom", false, { "a", "pull", "b", "-v", "-u", "x", "-t", "5", "--", "-c" } },
+		{ "cli-w", "w_specialization_example/bin", "./cli-w", false, { "-Wno-sign-conversion", "-Werror-level=3", "-Wtype=dir", "-Dconfig=abc", "-Dlevel=2" } },
+		{ "cli-daemon", "daemon_example/bin", "./cli-daemon", false, { "-v", "fetch", "-n", "3", "x" } },
+		{ "cli-client to cli-daemon", "daemon_client/bin", "./cli-client", true, { "../../daemon_example/bin/.cli-daemon.sock", "cli-daemon", "-v", "fetch", "-n", "3", "x" } },
+	};
+	return scenarios;
+}
+
+static const char * syscall_name(long number) {
+	static const std::pair<long, const char *> names[] = {
+		{ SYS_read, "read" }, { SYS_write, "write" }, { SYS_close, "close" },
+		{ SYS_openat, "openat" }, { SYS_mmap, "mmap" }, { SYS_mprotect, "mprotect" },
+		{ SYS_munmap, "munmap" }, { SYS_brk, "brk" }, { SYS_execve, "execve" },
+		{ SYS_exit_group, "exit_group" }, { SYS_lseek, "lseek" }, { SYS_ioctl, "ioctl" },
+		{ SYS_pread64, "pread64" }, { SYS_getrandom, "getrandom" }, { SYS_futex, "futex" },
+		{ SYS_set_tid_address, "set_tid_address" }, { SYS_set_robust_list, "set_robust_list" },
+		{ SYS_rt_sigaction, "rt_sigaction" }, { SYS_rt_sigprocmask, "rt_sigprocmask" },
+		{ SYS_prlimit64, "prlimit64" }, { SYS_newfstatat, "newfstatat" }, { SYS_fstat, "fstat" },
+		{ SYS_fcntl, "fcntl" }, { SYS_socket, "socket" }, { SYS_connect, "connect" }, { SYS_sendmsg, "sendmsg" },
+		{ SYS_rename, "rename" }, { SYS_sendfile, "sendfile" }, { SYS_unlink, "unlink" },
+#ifdef SYS_open
+		{ SYS_open, "open" }, { SYS_stat, "stat" }, { SYS_access, "access" }, { SYS_arch_prctl, "arch_prctl" },
+#endif
+#ifdef SYS_rseq
+		{ SYS_rseq, "rseq" },
+#endif
+	};
+	for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		if (names[i].first == number) {
+			return names[i].second;
+		}
+	}
+	return nullptr;
+}
+
+#if defined(__x86_64__)
+// Reads a path from the traced process one word at a time.
+static std::string read_child_string(pid_t pid, unsigned long long address) {
+	std::string str;
+	while (str.size() < 4096) {
+		errno = 0;
+		long word = ptrace(PTRACE_PEEKDATA, pid, (void *)(address + str.size()), nullptr);
+		if (errno != 0) {
+			break;
+		}
+		const char * bytes = (const char *)&word;
+		for (size_t i = 0; i < sizeof(word); i++) {
+			if (bytes[i] == '\0') {
+				return str;
+			}
+			str += bytes[i];
+		}
+	}
+	return str;
+}
+
+static void count_syscall(pid_t pid, bool entering, Syscall_Counts& counts, std::set<long>& help_fds, bool& opening_help_file) {
+	struct user_regs_struct regs;
+	if (ptrace(PTRACE_GETREGS, pid, nullptr, &regs) != 0) {
+		return;
+	}
+	long number = regs.orig_rax;
+	if (!entering) {
+		if (opening_help_file && (long)regs.rax >= 0) {
+			help_fds.insert((long)regs.rax);
+		}
+		opening_help_file = false;
+		return;
+	}
+	counts.by_number[number]++;
+	counts.total++;
+	if (number == SYS_openat || number == SYS_open) {
+		std::string path = read_child_string(pid, number == SYS_openat ? regs.rsi : regs.rdi);
+		opening_help_file = path.find("help_file") != std::string::npos;
+		counts.help_file_opens += opening_help_file;
+	} else if (number == SYS_write && help_fds.count((long)regs.rdi) != 0) {
+		counts.help_file_writes++;
+		counts.help_file_bytes += regs.rdx;
+	} else if (number == SYS_close) {
+		help_fds.erase((long)regs.rdi);
+	}
+}
+#endif
+
+static pid_t start(const Scenario& scenario, const std::string& root, bool traced) {
+	std::string directory = root + "/" + scenario.directory;
+	std::vector<char *> argv;
+	argv.push_back(const_cast<char *>(scenario.program));
+	for (size_t i = 0; i < scenario.args.size(); i++) {
+		argv.push_back(const_cast<char *>(scenario.args[i]));
+	}
+	argv.push_back(nullptr);
+
+	pid_t pid = fork();
+	if (pid == 0) {
+		int null_fd = open("/dev/null", O_WRONLY);
+		if (chdir(directory.c_str()) != 0 || null_fd < 0) {
+			_exit(127);
+		}
+		dup2(null_fd, STDOUT_FILENO);
+		dup2(null_fd, STDERR_FILENO);
+		if (traced) {
+			ptrace(PTRACE_TRACEME, 0, nullptr, nullptr);
+			raise(SIGSTOP);
+		}
+		execv(scenario.program, argv.data());
+		_exit(127);
+	}
+	return pid;
+}
+
+static Run_Result run(const Scenario& scenario, const std::string& root) {
+	struct rusage usage;
+	int status = 0;
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	pid_t pid = start(scenario, root, false);
+	if (pid < 0 || wait4(pid, &status, 0, &usage) < 0) {
+		return { 0, 0, -1 };
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	return { std::chrono::duration<double, std::nano>(end - begin).count(), usage.ru_maxrss, status };
+}
+
+// Returns false if the process could not be traced.
+static bool trace(const Scenario& scenario, const std::string& root, Syscall_Counts& counts) {
+#if defined(__x86_64__)
+	int status = 0;
+	pid_t pid = start(scenario, root, true);
+	if (pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFSTOPPED(status)) {
+		return false;
+	}
+	if (ptrace(PTRACE_SETOPTIONS, pid, nullptr, (void *)(long)(PTRACE_O_TRACESYSGOOD | PTRACE_O_EXITKILL)) != 0) {
+		kill(pid, SIGKILL);
+		waitpid(pid, &status, 0);
+		return false;
+	}
+	std::set<long> help_fds;
+	bool opening_help_file = false;
+	bool entering = true;
+	int signal_to_deliver = 0;
+	while (ptrace(PTRACE_SYSCALL, pid, nullptr, (void *)(long)signal_to_deliver) == 0 && waitpid(pid, &status, 0) >= 0) {
+		signal_to_deliver = 0;
+		if (WIFEXITED(status) || WIFSIGNALED(status)) {
+			return true;
+		}
+		if (WSTOPSIG(status) == (SIGTRAP | 0x80)) {
+			count_syscall(pid, entering, counts, help_fds, opening_help_file);
+			entering = !entering;
+		} else if (WSTOPSIG(status) != SIGTRAP) {
+			// The SIGTRAP after a successful execve is not a real signal.
+			signal_to_deliver = WSTOPSIG(status);
+		}
+	}
+	return false;
+#else
+	(void)scenario;
+	(void)root;
+	(void)counts;
+	return false;
+#endif
+}
+
+// Starts cli-daemon serving in its bin directory and waits until it accepts
+// connections. Returns the pid of the server, or -1 if it could not be
+// started.
+static pid_t start_server(const std::string& root) {
+	std::string directory = root + "/daemon_example/bin";
+	std::string socket_path = directory + "/.cli-daemon.sock";
+	if (access((directory + "/cli-daemon").c_str(), X_OK) != 0) {
+		return -1;
+	}
+	pid_t pid = fork();
+	if (pid == 0) {
+		int null_fd = open("/dev/null", O_WRONLY);
+		if (chdir(directory.c_str()) != 0 || null_fd < 0) {
+			_exit(127);
+		}
+		dup2(null_fd, STDOUT_FILENO);
+		dup2(null_fd, STDERR_FILENO);
+		execl("./cli-daemon", "./cli-daemon", "--serve", ".cli-daemon.sock", (char *)nullptr);
+		_exit(127);
+	}
+	if (pid < 0) {
+		return -1;
+	}
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socket_path.size() >= sizeof(address.sun_path)) {
+		kill(pid, SIGTERM);
+		waitpid(pid, nullptr, 0);
+		return -1;
+	}
+	memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+	for (int attempt = 0; attempt < 200; attempt++) {
+		int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		// A connection with no request in it is just closed by the server.
+		bool connected = fd >= 0 && connect(fd, (const struct sockaddr *)&address, sizeof(address)) == 0;
+		if (fd >= 0) {
+			close(fd);
+		}
+		if (connected) {
+			return pid;
+		}
+		usleep(10000);
+	}
+	kill(pid, SIGTERM);
+	waitpid(pid, nullptr, 0);
+	return -1;
+}
+
+template <typename T>
+static T percentile(const std::vector<T>& sorted, size_t p) {
+	size_t i = sorted.size() * p / 100;
+	return sorted[i < sorted.size() ? i : sorted.size() - 1];
+}
+
+int main(int argc, char ** argv) {
+	size_t runs = 1000;
+	std::string root = "../..";
+	bool count_syscalls = true;
+	{
+		cli::Parser p;
+		p.arg(runs, { "n", "runs" }, "Number of timed runs per command line.");
+		p.arg(root, { "root" }, "The directory holding the example directories, src in the repository.");
+		p.value(count_syscalls, { "no-syscalls" }, false, "Do not trace the programs to count their syscalls.");
+		p.parse(argc, argv);
+	}
+	if (runs == 0) {
+		runs = 1;
+	}
+
+	std::cout << "runs per command line:\t" << runs << std::endl;
+	pid_t server = start_server(root);
+	for (size_t s = 0; s < scenarios().size(); s++) {
+		const Scenario& scenario = scenarios()[s];
+		std::string program = root + "/" + scenario.directory + "/" + scenario.program;
+		if (access(program.c_str(), X_OK) != 0) {
+			std::cout << scenario.name << ":\tnot built, skipped" << std::endl;
+			continue;
+		}
+		if (scenario.served && server < 0) {
+			std::cout << scenario.name << ":\tserver not running, skipped" << std::endl;
+			continue;
+		}
+
+		std::vector<double> times;
+		std::vector<long> peak_rss;
+		times.reserve(runs);
+		peak_rss.reserve(runs);
+		size_t failures = 0;
+		double total_nanoseconds = 0;
+		for (size_t i = 0; i < runs; i++) {
+			Run_Result result = run(scenario, root);
+			if (!WIFEXITED(result.status) || WEXITSTATUS(result.status) != 0) {
+				failures++;
+			}
+			times.push_back(result.nanoseconds);
+			peak_rss.push_back(result.max_rss_kib);
+			total_nanoseconds += result.nanoseconds;
+		}
+		std::sort(times.begin(), times.end());
+		std::sort(peak_rss.begin(), peak_rss.end());
+
+		std::cout << scenario.name << ":" << std::endl;
+		std::cout << "\twall time:\tp50 " << percentile(times, 50) / 1000 << " us\tp99 " << percentile(times, 99) / 1000 << " us\tmax " << times.back() / 1000 << " us" << std::endl;
+		std::cout << "\tthroughput:\t" << (total_nanoseconds > 0 ? (size_t)(runs * 1e9 / total_nanoseconds) : 0) << " runs/s" << std::endl;
+		std::cout << "\tpeak RSS:\tp50 " << percentile(peak_rss, 50) << " KiB\tmax " << peak_rss.back() << " KiB" << std::endl;
+		if (failures != 0) {
+			std::cout << "\tfailed runs:\t" << failures << std::endl;
+		}
+
+		Syscall_Counts counts;
+		if (!count_syscalls) {
+			continue;
+		}
+		if (!trace(scenario, root, counts)) {
+			std::cout << "\tsyscalls:\tcould not trace the program" << std::endl;
+			continue;
+		}
+		std::vector<std::pair<size_t, long>> by_count;
+		for (std::map<long, size_t>::const_iterator it = counts.by_number.begin(); it != counts.by_number.end(); ++it) {
+			by_count.push_back(std::make_pair(it->second, it->first));
+		}
+		std::sort(by_count.rbegin(), by_count.rend());
+		std::cout << "\tsyscalls:\t" << counts.total << " total";
+		for (size_t i = 0; i < by_count.size() && i < 8; i++) {
+			const char * name = syscall_name(by_count[i].second);
+			std::cout << (i == 0 ? ": " : ", ");
+			if (name != nullptr) {
+				std::cout << name;
+			} else {
+				std::cout << "#" << by_count[i].second;
+			}
+			std::cout << " " << by_count[i].first;
+		}
+		std::cout << std::endl;
+		std::cout << "\thelp files:\t" << counts.help_file_opens << " opens, " << counts.help_file_writes << " writes, " << counts.help_file_bytes << " bytes" << std::endl;
+	}
+	if (server >= 0) {
+		kill(server, SIGTERM);
+		waitpid(server, nullptr, 0);
+		unlink((root + "/daemon_example/bin/.cli-daemon.sock").c_str());
+	}
+	return 0;
+}
@@ -0,0 +1,179 @@
+#include "cpp_cli.h"
+#include "batch_parse.h"
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+// A small tool that takes its paths from standard input, one per line or
+// separated by NUL bytes with -0, which keeps a long list off the command line:
+//
+//	find . -name '*.cpp' | ./cli-stream --prefix=index: -v
+//	find . -name '*.cpp' -print0 | ./cli-stream -0
+//
+// Options can be mixed in with the paths, and commands are not recognized in
+// the stream, so a path named like a command is still a path. The settings of
+// a command line can be saved to a snapshot and loaded in place of the command
+// line, -0 included:
+//
+//	./cli-stream --prefix=index: -vv --save=index.snapshot
+//	find . -name '*.cpp' | ./cli-stream --load=index.snapshot
+//
+// With --batch, the rest of the command line is split on ";" and every part
+// runs as a command of its own, two at a time:
+//
+//	./cli-stream --batch fetch -n 2 a \; index -d 3 b \; fetch c
+
+struct Tool {
+	cli::Parser p;
+	size_t verbosity = 0;
+	std::string prefix;
+	bool null_separated = false;
+	std::string save_path;
+	std::string load_path;
+	size_t paths = 0;
+	bool help_printed = false;
+};
+
+struct Fetch_Options {
+	int count = 1;
+};
+
+struct Index_Options {
+	int depth = 0;
+};
+
+void print_help(cli::Parser& p, void * data) {
+	static_cast<Tool *>(data)->help_printed = true;
+	p.print_help();
+}
+
+void build_fetch(cli::Parser& p, void * data) {
+	(void)data;
+	Fetch_Options& o = p.command_state<Fetch_Options>();
+	p.arg(o.count, { "n", "count" }, "How many times to fetch each URL.");
+}
+
+void run_fetch(cli::Parser& p, void * data) {
+	(void)data;
+	Fetch_Options& o = p.command_state<Fetch_Options>();
+	const cli::cli_vector<const char *>& urls = p.get_non_options();
+	for (size_t i = 0; i < urls.size(); i++) {
+		// One write per line, as commands of a batch run at the same time.
+		std::cout << std::string("fetch ") + urls[i] + " x" + std::to_string(o.count) + "\n";
+	}
+}
+
+void build_index(cli::Parser& p, void * data) {
+	(void)data;
+	Index_Options& o = p.command_state<Index_Options>();
+	p.arg(o.depth, { "d", "depth" }, "How deep to index.");
+}
+
+void run_index(cli::Parser& p, void * data) {
+	(void)data;
+	Index_Options& o = p.command_state<Index_Options>();
+	const cli::cli_vector<const char *>& paths = p.get_non_options();
+	for (size_t i = 0; i < paths.size(); i++) {
+		std::cout << std::string("index ") + paths[i] + " to depth " + std::to_string(o.depth) + "\n";
+	}
+}
+
+// Called by parse_stream with every path, with the options before it already
+// applied.
+void handle_path(const char * path, void * data) {
+	Tool * tool = static_cast<Tool *>(data);
+	tool->paths++;
+	std::cout << tool->prefix << path;
+	if (tool->verbosity > 0) {
+		std::cout << " (verbosity " << tool->verbosity << ")";
+	}
+	std::cout << std::endl;
+}
+
+int run_batch(Tool& tool, int argc, char ** argv) {
+	// argv[0] is --batch, which parse_batch skips like a program name.
+	std::vector<cli::Batch_Result> results = cli::parse_batch(tool.p, argc, argv, ";", 2, &tool);
+	int status = 0;
+	for (size_t i = 0; i < results.size(); i++) {
+		if (results[i].error) {
+			std::cerr << results[i].error.message() << std::endl;
+			status = 2;
+		}
+	}
+	return status;
+}
+
+int main(int argc, char ** argv) {
+	Tool tool;
+	tool.p.count(tool.verbosity, { "v", "verbose" }, "Prints more. Can be repeated.");
+	tool.p.arg(tool.prefix, { "p", "prefix" }, "Printed before every path.");
+	tool.p.value(tool.null_separated, { "0", "null" }, true, "Paths are separated by NUL bytes instead of newlines.");
+	tool.p.arg(tool.save_path, { "save" }, "Saves the settings to a snapshot file and exits.");
+	tool.p.arg(tool.load_path, { "load" }, "Loads the settings from a snapshot file instead of the command line.");
+	tool.p.action(print_help, &tool, { "h", "help" }, "Prints this help message and exits.");
+	tool.p.add_command("fetch", build_fetch, run_fetch, "Fetches every URL given to it.");
+	tool.p.add_command("index", build_index, run_index, "Indexes every path given to it.");
+
+	tool.p.set_usage("[-v] [-0] [-p prefix] < paths\n\t[command] [command's options/non-options]\n\t--batch [command] [...] \\; [command] [...]");
+	tool.p.set_header("Demonstrates reading arguments from standard input with parse_stream, "
+	"saving and loading settings as snapshots, and running commands in a batch with parse_batch.");
+	tool.p.set_help_file_path("");
+	tool.p.generate_help(argv[0]);
+
+	if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+		return run_batch(tool, argc - 1, argv + 1);
+	}
+
+	cli::Parse_Error error = tool.p.try_parse(argc, argv, &tool);
+	if (error) {
+		std::cerr << error.message() << std::endl;
+		return 2;
+	}
+	if (tool.help_printed) {
+		return 0;
+	}
+	// A command leaves a null in front of its name, and has run already.
+	const cli::cli_vector<const char *>& non_options = tool.p.get_non_options();
+	for (size_t i = 0; i < non_options.size(); i++) {
+		if (non_options[i] == nullptr) {
+			return 0;
+		}
+	}
+	if (!tool.save_path.empty()) {
+		const std::string path = tool.save_path;
+		tool.save_path.clear();
+		int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0) {
+			std::cerr << "Could not open " << path << std::endl;
+			return 1;
+		}
+		tool.p.write_snapshot(fd);
+		close(fd);
+		return 0;
+	}
+	if (!tool.load_path.empty()) {
+		int fd = open(tool.load_path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			std::cerr << "Could not open " << tool.load_path << std::endl;
+			return 1;
+		}
+		cli::Mapped_Snapshot snapshot(fd);
+		close(fd);
+		if (!tool.p.load_snapshot(snapshot.data(), snapshot.size())) {
+			std::cerr << "The snapshot was saved from different options." << std::endl;
+			return 1;
+		}
+	}
+
+	// Paths on the command line come before the ones on standard input.
+	for (size_t i = 0; i < non_options.size(); i++) {
+		handle_path(non_options[i], &tool);
+	}
+	tool.p.parse_stream(STDIN_FILENO, handle_path, &tool, tool.null_separated ? '\0' : '\n');
+	if (tool.verbosity > 1) {
+		std::cout << tool.paths << " paths" << std::endl;
+	}
+	return 0;
+}
@@ -4,14 +4,14 @@
 
 void push_prog(int argc, char ** argv, void * data);
 void test_prog(int argc, char ** argv, void * data);
-void pull_prog(int argc, char ** argv, void * data);
+void build_pull(cli::Parser& p, void * data);
+void run_pull(cli::Parser& p, void * data);
 
 bool help = false;
 
 struct Main_Subcommand_Variables {
 	std::string file_path;
 	size_t verbosity = 0;
-	std::vector<const char *> non_options;
 };
 
 int main(int argc, char ** argv) {
@@ -19,10 +19,11 @@ int main(int argc, char ** argv) {
 	Parser p;
 	Main_Subcommand_Variables msv;
 	p.arg(msv.file_path, { "path", "p" }, "Dummy variable.");
-	p.repeated(msv.verbosity, { "v" }, "Dummy variable.");
+	// Global, so '-v' is accepted after 'pull' as well.
+	p.global(p.repeated(msv.verbosity, { "v" }, "Dummy variable."));
 	p.value(help, { "h", "help" }, true, "Prints this help message and exits.");
 	
-	p.add_subcommand("pull", pull_prog, "Does something like 'git pull' if this program actually did anything.");
+	p.add_command("pull", build_pull, run_pull, "Does something like 'git pull' if this program actually did anything. Its options are only registered if it is used.");
 	p.add_subcommand("push", push_prog, "Does something like 'git push' if this program actually did anything.");
 
 	p.set_help_file_path("");
@@ -43,7 +44,7 @@ int main(int argc, char ** argv) {
 
 	p.generate_help(argv[0]);
 
-	msv.non_options = p.parse(argc, argv, &msv);
+	Parse_Result result = p.parse_levels(argc, argv, &msv);
 
 	if (help) {
 		p.print_help();
@@ -54,12 +55,15 @@ int main(int argc, char ** argv) {
 	std::cout << "verbosity: " << msv.verbosity << std::endl;
 	
 	std::string nesting = "";
-	for (size_t i = 0; i < msv.non_options.size(); i++) {
-		if (msv.non_options[i] == nullptr) {
-			nesting += "\t";
-			continue;
+	for (size_t level = 0; level < result.size(); level++) {
+		std::cout << nesting << "COMMAND: " << result[level].name << std::endl;
+		for (size_t i = 0; i < result[level].positionals.size(); i++) {
+			std::cout << nesting << "NON_OPTION " << std::to_string(i) << ": " << result[level].positionals[i] << std::endl;
 		}
-		std::cout << nesting << "NON_OPTION " << std::to_string(i) << ": " << msv.non_options[i] << std::endl;
+		for (size_t i = 0; i < result[level].after_dash_dash.size(); i++) {
+			std::cout << nesting << "AFTER --: " << result[level].after_dash_dash[i] << std::endl;
+		}
+		nesting += "\t";
 	}
 }
 
@@ -94,33 +98,35 @@ void push_prog(int argc, char ** argv, void * data) {
 	std::cout << "LEAVING SUBCOMMAND PUSH" << std::endl << std::endl;
 }
 
-void pull_prog(int argc, char ** argv, void * data) {
-	using namespace cli;
-	Parser p;
-	(void)data;
+struct Pull_Options {
 	std::string URL = "";
 	unsigned long long timeout = 100;
-	p.arg(URL, { "u", "URL" }, "Sets the URL.");
-	p.arg(timeout, { "t", "timeout" }, "Sets the amount of time before a timeout.");
+};
+
+// Only called if 'pull' is on the command line. The parser carries on with
+// these options, plus the global ones, right after the 'pull'.
+void build_pull(cli::Parser& p, void * data) {
+	(void)data;
+	Pull_Options& o = p.command_state<Pull_Options>();
+	p.arg(o.URL, { "u", "URL" }, "Sets the URL.");
+	p.arg(o.timeout, { "t", "timeout" }, "Sets the amount of time before a timeout.");
 	p.value(help, { "h", "help" }, true, "Displays this help message and exits.");
-	p.generate_help(argv[0]);
-	try {
-		p.parse(argc, argv, nullptr);
-	} catch (std::invalid_argument& e) {
-		std::cerr << "INVALID ARGUMENT FOR SUBCOMMAND PULL" << std::endl;
-		throw;
-	}
-	
+	p.generate_help("pull");
+}
+
+// Called once the whole command line has been parsed.
+void run_pull(cli::Parser& p, void * data) {
 	if (help) {
 		return;
 	}
+	Pull_Options& o = p.command_state<Pull_Options>();
+	Main_Subcommand_Variables * fixed_data = static_cast<Main_Subcommand_Variables*>(data);
 	std::cout << std::endl << "IN SUBCOMMAND PULL" << std::endl;
-	std::cout << "argc: " << argc << std::endl;
-	std::cout << "argv[0]: " << argv[0] << std::endl;
+	std::cout << "verbosity: " << fixed_data->verbosity << std::endl;
 
 
-	std::cout << "URL: " << URL << std::endl;
-	std::cout << "Timeout: " << timeout << std::endl;
+	std::cout << "URL: " << o.URL << std::endl;
+	std::cout << "Timeout: " << o.timeout << std::endl;
 	std::cout << "LEAVING SUBCOMMAND PULL" << std::endl << std::endl;
 }
 
@@ -1,20 +1,41 @@
 #include "cpp_cli.h"
+#include "lazy.h"
 #include <iostream>
 #include <vector>
 #include <string>
 
+// Stands in for an expensive default, like counting CPUs or looking up the
+// host name. It only runs if --jobs was not given and jobs is actually read.
+int detect_number_of_jobs() {
+	std::cout << "(detecting the number of jobs)" << std::endl;
+	return 4;
+}
+
+// Actions run as soon as their flag is seen, and nothing after it is parsed.
+void print_help(cli::Parser& p, void * data) {
+	(void)data;
+	p.print_help();
+}
+
+void print_version(cli::Parser& p, void * data) {
+	(void)p;
+	std::cout << (const char *)data << std::endl;
+}
+
 int main(int argc, char ** argv) {
 	using namespace cli;
 	std::string filename = "a.out";
 	int recursion_level = -1;
 	char flag = '\0';
+	char file_type = 'x';
+	char color = 'a';
 	std::string flag2 = "false";
 	double probability_of_success = 0.0001;
 	std::string standard_input_hyphen = "";
-	size_t verbosity;
-	bool help = false;
+	size_t verbosity = 0;
 	std::vector<int> list_of_ints;
 	std::vector<const char *> list_of_declarations;
+	Lazy<int> jobs(detect_number_of_jobs);
 	list_of_ints.reserve(30);
 
 	// non_options is a vector of args that did not start with a hyphen, did not
@@ -45,7 +66,7 @@ int main(int argc, char ** argv) {
 	p.set_help_file_path("");
 
 	p.arg(filename, { "f", "file", "filename" }, "Determines the file to be read. In this program, though, it doesn't do anything.");
-	p.arg(recursion_level, { "r", "recursion", "max-depth" }, "Determines the maximum level of recursion allowed before nothing happens because this is a test program.");
+	cli::CLI_Interface * recursion = p.arg(recursion_level, { "r", "recursion", "max-depth" }, "Determines the maximum level of recursion allowed before nothing happens because this is a test program.");
 	p.arg(probability_of_success, { "p", "prob", "probability" }, "Sets the probability of this program working properly, which is mostly dependent on whether or not I forgot a minor syntax error.");
 	p.repeated(verbosity, { "v" }, "This is a standard verbosity variable that is supposed to set increasing levels of verbosity, so -v would mean be a little verbose, -vvvv would mean be very verbose, etc.");
 
@@ -56,6 +77,16 @@ int main(int argc, char ** argv) {
 	p.value(flag, { "no-flag", "b" }, 'b', "Same as --flag, -a, except it will set the flag variable to a different value.");
 	p.value(flag, { "some-flag", "c" }, 'c', "Same as --flag, -a, except it will set the flag variable to a different value.");
 
+	// Passing both of these is an error rather than the last one winning.
+	cli::CLI_Interface * color_on = p.value(color, { "color" }, 'y', "Always colors the output.");
+	cli::CLI_Interface * color_off = p.value(color, { "no-color" }, 'n', "Never colors the output.");
+	p.exclusive({ color_on, color_off });
+
+	// A choice maps each of a fixed set of names to a value with a single
+	// lookup, so --type=dir sets file_type to 'd'. The valid names are added
+	// to the help message automatically.
+	p.choice(file_type, { "t", "type" }, { { "file", 'f' }, { "dir", 'd' }, { "link", 'l' } }, "Sets the type of file to look for.");
+
 	// Generally, the solitary hyphen flag is used to indicate that the
 	// program should take in standard input. The library will tell you that
 	// someone typed a hyphen, and it is up to you to determine what you
@@ -75,7 +106,13 @@ int main(int argc, char ** argv) {
 	// cause the program to fail and tell you which flag.
 	// Var<int> breaks_program(nullptr, { "l" }, false);
 
-	p.value(help, { "h", "help" }, true, "Prints this help message and exits.");
+	// The help file is only written once parsing is done, or when it is
+	// printed, so --version never writes it.
+	p.action(print_help, nullptr, { "h", "help" }, "Prints this help message and exits.");
+	p.action(print_version, (void *)"cli-test 1.0", { "version" }, "Prints the version and exits.");
+
+	// A Lazy only keeps a pointer to its argument until it is read.
+	p.arg(jobs, { "j", "jobs" }, "Sets the number of jobs. Defaults to a value that is only computed if it is needed.");
 
 	p.vector(list_of_ints, { "i", "list" }, "Just here to demonstrate that it can deal with vectors of arguments.");
 	p.vector(list_of_declarations, { "D" }, "Just here to demonstrate that const char *'s work.");
@@ -86,17 +123,26 @@ int main(int argc, char ** argv) {
 	// need to use them.
 	non_options = p.parse(argc, argv);
 
-	// This section just prints out the values to demonstrate that hash worked.
-	if (help) {
-		p.print_help();
-	} else {
+	// This section just prints out the values to demonstrate that hash worked,
+	// unless an action already did everything there was to do.
+	if (p.action_taken() == nullptr) {
 		std::cout << "filename:\t" << filename << std::endl;
-		std::cout << "recursion:\t" << recursion_level << std::endl;
+		// seen tells whether -r was given, so that -r -1 can be told apart
+		// from not passing it at all.
+		if (p.seen(recursion)) {
+			std::cout << "recursion:\t" << recursion_level << std::endl;
+		} else {
+			std::cout << "recursion:\tunlimited" << std::endl;
+		}
 		std::cout << "flag:\t\t'" << flag << "'" << std::endl;
 		std::cout << "flag2:\t\t" << flag2 << std::endl;
+		std::cout << "file_type:\t'" << file_type << "'" << std::endl;
+		std::cout << "color:\t\t'" << color << "'" << std::endl;
 		std::cout << "probability_of_success:\t" << probability_of_success << std::endl;
 		std::cout << "standard_input_hyphen:\t" << standard_input_hyphen << std::endl;
 		std::cout << "verbosity:\t" << verbosity << std::endl;
+		int number_of_jobs = *jobs;
+		std::cout << "jobs:\t\t" << number_of_jobs << std::endl;
 		std::string list_of_ints_string;
 		list_of_ints_string.reserve(100);
 		for (size_t i = 0; i < list_of_ints.size(); i++) {
@@ -21,11 +21,17 @@ int main(int argc, char ** argv) {
 	int w_error_level = 1;
 	int w_warning_level = 1;
 	char w_type = 'x';
+	unsigned int w_sanitize = 0;
+	bool l_gc_sections = false;
+	int l_optimization = 0;
+	Arg_View l_rpath;
+	std::vector<Arg_View> l_pass_through;
 
 	bool d_ignore_parentheses = false;
 	bool d_allow_infinite_recursion = false;
 	std::string d_configuration_name = "";
 	int d_debug_level = 0;
+	std::vector<std::string> d_search_paths;
 
 	bool help = false;
 	
@@ -40,16 +46,27 @@ int main(int argc, char ** argv) {
 
 		// YOU DO NOT NEED TO USE WSpecializationS, WvalueS, or WargS
 		WSpecialization w_options(100);
-		Wvalue<bool> w_sign_conversion_var(w_sign_conversion, w_options, "sign-conversion", true);
-		Wvalue<bool> w_no_sign_conversion_var(w_sign_conversion, w_options, "no-sign-conversion" , false);
+		// Wflag also accepts -Wno-sign-conversion, so there is no need for a
+		// separate Wvalue for the negated flag.
+		Wflag<bool> w_sign_conversion_var(w_sign_conversion, w_options, "sign-conversion");
 		Wvalue<bool> w_all_var(w_all, w_options, "all", true);
 		Wvalue<bool> w_extra_var(w_extra, w_options, "extra", true);
-		Wvalue<char> w_type_a_var(w_type, w_options, "file", 'f');
-		Wvalue<char> w_type_b_var(w_type, w_options, "dir", 'd');
-		Wvalue<char> w_type_c_var(w_type, w_options, "link", 'l');
-		Wvalue<char> w_type_d_var(w_type, w_options, "any", 'a');
+		Wchoice<char> w_type_var(w_type, w_options, "type", { { "file", 'f' }, { "dir", 'd' }, { "link", 'l' }, { "any", 'a' } });
 		Warg<int> w_error_level_var(w_error_level, w_options, "error-level");
 		Warg<int> w_warning_level_var(w_warning_level, w_options, "warning-level");
+		// -Wsanitize=address,thread sets bits 0 and 2, -Wno-sanitize=thread clears bit 2.
+		Wbitmask<unsigned int> w_sanitize_var(w_sanitize, w_options, "sanitize", { "address", "undefined", "thread", "leak" });
+
+		// -Wl,gc-sections,O=2,--as-needed forwards every item to l_options,
+		// and the items it does not know, like --as-needed, to l_pass_through.
+		WSpecialization l_options(4);
+		Wflag<bool> l_gc_sections_var(l_gc_sections, l_options, "gc-sections");
+		Warg<int> l_optimization_var(l_optimization, l_options, "O");
+		// A value in the middle of a list, as in -Wl,rpath=/usr/lib,O=2, is
+		// not terminated in the command line, so it is kept as a view. A
+		// const char * would be rejected there.
+		Warg<Arg_View> l_rpath_var(l_rpath, l_options, "rpath");
+		Wgroup w_l_var(l_options, w_options, "l", &l_pass_through);
 		p.arg(w_options, { "W" }, "Only the -W main argument has a help message at this point because these options are better documented outside of a simple help message.");
 
 		WSpecialization d_options(100);
@@ -58,6 +75,7 @@ int main(int argc, char ** argv) {
 		Wvalue<bool> d_no_infinite_recursion_var(d_allow_infinite_recursion, d_options, "no-infinite-recursion", false);
 		Warg<std::string> d_configuration_name_var(d_configuration_name, d_options, "config");
 		Warg<int> d_debug_level_var(d_debug_level, d_options, "level");
+		Wlist<std::string> d_search_paths_var(d_search_paths, d_options, "path");
 		p.arg(d_options, { "D" }, "Just here for fun.");
 
 		p.value(help, { "help", "h" }, true, "Displays this help message and exits.");
@@ -105,12 +123,22 @@ int main(int argc, char ** argv) {
 	std::cout << "w_error_level:\t" << w_error_level << std::endl;
 	std::cout << "w_warning_level:\t" << w_warning_level << std::endl;
 	std::cout << "w_type:\t" << w_type << std::endl;
+	std::cout << "w_sanitize:\t" << w_sanitize << std::endl;
+	std::cout << "l_gc_sections:\t" << l_gc_sections << std::endl;
+	std::cout << "l_optimization:\t" << l_optimization << std::endl;
+	std::cout << "l_rpath:\t" << l_rpath.str() << std::endl;
+	for (size_t i = 0; i < l_pass_through.size(); i++) {
+		std::cout << "l_pass_through " << i << ":\t" << l_pass_through[i].str() << std::endl;
+	}
 
 	std::cout << "--------------------D FLAGS---------------------" << std::endl;
 	std::cout << "d_ignore_parentheses:\t" << d_ignore_parentheses << std::endl;
 	std::cout << "d_allow_infinite_recursion:\t" << d_allow_infinite_recursion << std::endl;
 	std::cout << "d_configuration_name:\t" << d_configuration_name << std::endl;
 	std::cout << "d_debug_level:\t" << d_debug_level << std::endl;
+	for (size_t i = 0; i < d_search_paths.size(); i++) {
+		std::cout << "d_search_paths " << i << ":\t" << d_search_paths[i] << std::endl;
+	}
 	
 	for (size_t i = 0; i < non_options.size(); i++) {
 		std::cout << "NON_OPTION " << i << ":\t" << non_options[i] << std::endl;